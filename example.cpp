@@ -13,6 +13,7 @@
 #define NF_LOGGING
 
 #include "normalform/normalform.h"
+#include "normalform/compose.h"
 #include "normalform/prettyprint.h"
 
 
@@ -33,29 +34,42 @@ int main(int argc, char* argv[])
 	typedef CMonomCoeff<N>  Term;
 	typedef complex<double> Complex;
 
-	// construct hamiltonian
-	IntPower m1000[] = {1,0,0,0}; // Q1 monom powers
-	IntPower m0100[] = {0,1,0,0}; // Q2 monom powers
-	IntPower m0010[] = {0,0,1,0}; // P1 monom powers
-	IntPower m0001[] = {0,0,0,1}; // P2 monom powers
-	// complex coordinates to diagonalize linear part
-	// q1 = (Q1+i*P1)/sqrt(2),  p1 = (i*Q1+P1)/sqrt(2)
-	// q2 = (Q2+i*P2)/sqrt(2),  p2 = (i*Q2+P2)/sqrt(2)
-	Polynom q1 = Term(Complex(sqrt(0.5),0), m1000) + Term(Complex(0,sqrt(0.5)), m0010);
-	Polynom p1 = Term(Complex(0,sqrt(0.5)), m1000) + Term(Complex(sqrt(0.5),0), m0010);
-	Polynom q2 = Term(Complex(sqrt(0.5),0), m0100) + Term(Complex(0,sqrt(0.5)), m0001);
-	Polynom p2 = Term(Complex(0,sqrt(0.5)), m0100) + Term(Complex(sqrt(0.5),0), m0001);
+	// construct hamiltonian, monom powers of variables (Q1,Q2,P1,P2) before
+	// and (q1,q2,p1,p2) after substitution of complex coordinates
+	IntPower m1000[] = {1,0,0,0};
+	IntPower m0100[] = {0,1,0,0};
+	IntPower m0010[] = {0,0,1,0};
+	IntPower m0001[] = {0,0,0,1};
+	IntPower m2000[] = {2,0,0,0}, m0200[] = {0,2,0,0}, m0020[] = {0,0,2,0}, m0002[] = {0,0,0,2};
+	IntPower m2100[] = {2,1,0,0}, m0300[] = {0,3,0,0};
+
+	// H = (P1^2+P2^2)/2 + (Q1^2+Q2^2)/2 + Q1^2*Q2 - Q2^3/3
+	Polynom Hreal = Term(Complex(0.5), m0020) + Term(Complex(0.5), m0002) + Term(Complex(0.5), m2000) + Term(Complex(0.5), m0200)
+		+ Term(Complex(1.0), m2100) + Term(Complex(-1.0/3.0), m0300);
 
-	// H = (p1^2+p2^2)/2 + (q1^2+q2^2)/2 + q1^2*q2 - q2^3/3
-	Polynom H = Complex(0.5)*(p1*p1 + p2*p2 + q1*q1 + q2*q2) + q1*q1*q2 - Complex(1.0/3.0) * q2*q2*q2;
+	// complex coordinates to diagonalize linear part
+	// Q1 = (q1+i*p1)/sqrt(2),  P1 = (i*q1+p1)/sqrt(2)
+	// Q2 = (q2+i*p2)/sqrt(2),  P2 = (i*q2+p2)/sqrt(2)
+	boost::array<Polynom,2*N> coordinates;
+	coordinates[0] = Term(Complex(sqrt(0.5),0), m1000) + Term(Complex(0,sqrt(0.5)), m0010);
+	coordinates[1] = Term(Complex(sqrt(0.5),0), m0100) + Term(Complex(0,sqrt(0.5)), m0001);
+	coordinates[2] = Term(Complex(0,sqrt(0.5)), m1000) + Term(Complex(sqrt(0.5),0), m0010);
+	coordinates[3] = Term(Complex(0,sqrt(0.5)), m0100) + Term(Complex(sqrt(0.5),0), m0001);
 
-	H.Simplify();
+	// substitute coordinates, H has degree 3
+	Polynom H = compose(Hreal, coordinates, 3);
 
 	// set output precision (15 is maximal for double type)
 	cout << std::setprecision(14);
 
+	// H is invariant under reflection Q1 -> -Q1, P1 -> -P1,
+	// i.e. q1 -> -q1, p1 -> -p1; only orbit representatives are computed
+	CSymmetry<N> symmetry;
+	Complex reflection[] = {-1.0, 1.0};
+	symmetry.addPhase(reflection);
+
 	// initialize normal form
-	NormalForm<N,order> NF(H);
+	NormalForm<N,order> NF(H, symmetry);
 	cout << "H=\n" << NF.H << "\n\n";
 
 	// construct normal Form
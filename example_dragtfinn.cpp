@@ -0,0 +1,144 @@
+// Example for NormalForm library
+//
+// Dragt-Finn product normalization compared with the Deprit triangle for
+// Henon-Heiles type hamiltonian with non-resonant frequencies 1 and sqrt(2):
+// normal forms agree, forward and backward transforms are inverse to each
+// other and canonical up to the normalization order. Run times of both
+// algorithms are printed.
+
+#include "stdafx.h"
+
+#include <cmath>
+#include <complex>
+#include <ctime>
+#include <iostream>
+#include <algorithm>
+
+#include "normalform/normalform.h"
+#include "normalform/compose.h"
+
+
+using namespace normalform;
+using namespace std;
+
+
+const int N = 2;      // number of degree of freedom
+const int order = 10; // normalization order
+
+typedef CPolynom<N>     Polynom;
+typedef CMonomCoeff<N>  Term;
+typedef complex<double> Complex;
+typedef NormalForm<N,order> NormalFormType;
+
+// max coefficient of p
+double maxCoeff(const Polynom& p)
+{
+	double m = 0;
+	for(Polynom::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+		m = max(m, abs(it->second));
+	return m;
+}
+
+// terms of p up to degree d
+Polynom truncate(const Polynom& p, const size_t d)
+{
+	Polynom r;
+	for(Polynom::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+		if(it->first.degree() <= d)
+			r.list[it->first] = it->second;
+	return r;
+}
+
+// normalization time in seconds
+double normalize(NormalFormType& NF)
+{
+	clock_t start = clock();
+	NF.normalize();
+	return double(clock() - start) / CLOCKS_PER_SEC;
+}
+
+#ifdef _MSC_VER
+int _tmain(int, _TCHAR*[])
+#else
+int main()
+#endif
+{
+	const double w2 = sqrt(2.0);
+	// terms below 1e-8 are dropped in normalization, transforms are exact to about that level
+	const double tolerance = 1e-6;
+
+	IntPower m1000[] = {1,0,0,0};
+	IntPower m0100[] = {0,1,0,0};
+	IntPower m0010[] = {0,0,1,0};
+	IntPower m0001[] = {0,0,0,1};
+	IntPower m2000[] = {2,0,0,0}, m0200[] = {0,2,0,0}, m0020[] = {0,0,2,0}, m0002[] = {0,0,0,2};
+	IntPower m2100[] = {2,1,0,0}, m0300[] = {0,3,0,0};
+
+	// H = (P1^2+Q1^2)/2 + w2*(P2^2+Q2^2)/2 + Q1^2*Q2 - Q2^3/3
+	Polynom Hreal = Term(Complex(0.5), m0020) + Term(Complex(0.5*w2), m0002) + Term(Complex(0.5), m2000) + Term(Complex(0.5*w2), m0200)
+		+ Term(Complex(1.0), m2100) + Term(Complex(-1.0/3.0), m0300);
+
+	boost::array<Polynom,2*N> coordinates;
+	coordinates[0] = Term(Complex(sqrt(0.5),0), m1000) + Term(Complex(0,sqrt(0.5)), m0010);
+	coordinates[1] = Term(Complex(sqrt(0.5),0), m0100) + Term(Complex(0,sqrt(0.5)), m0001);
+	coordinates[2] = Term(Complex(0,sqrt(0.5)), m1000) + Term(Complex(sqrt(0.5),0), m0010);
+	coordinates[3] = Term(Complex(0,sqrt(0.5)), m0100) + Term(Complex(sqrt(0.5),0), m0001);
+
+	Polynom H = compose(Hreal, coordinates, 3);
+
+	NormalFormType deprit(H), dragtFinn(H);
+	dragtFinn.algorithm = DragtFinn;
+	double timeDeprit = normalize(deprit);
+	double timeDragtFinn = normalize(dragtFinn);
+
+	// normal form is unique in the non-resonant case, differences relative to the largest coefficient
+	double errorK = 0, scaleK = 0;
+	for(int n = 0; n < order; n++)
+	{
+		Polynom d = dragtFinn.K[n];
+		d -= deprit.K[n];
+		errorK = max(errorK, maxCoeff(d));
+		scaleK = max(scaleK, maxCoeff(deprit.K[n]));
+	}
+	errorK /= scaleK;
+
+	// transforms at eps = 1, monoms of degree above order are not normalized
+	boost::array<Polynom,2*N> X, Y;
+	for(int i = 0; i < 2 * N; i++)
+	{
+		X[i] = sumSerie(dragtFinn.getForwardTransform(i));
+		Y[i] = sumSerie(dragtFinn.getBackwardTransform(i));
+	}
+
+	// Y(X(x)) = x
+	IntPower* variables[] = {m1000, m0100, m0010, m0001};
+	double errorInverse = 0;
+	for(int i = 0; i < 2 * N; i++)
+	{
+		Polynom d = compose(Y[i], X, order);
+		d -= Polynom() + Term(Complex(1.0), variables[i]);
+		errorInverse = max(errorInverse, maxCoeff(d));
+	}
+
+	// {X_i, X_j} = {x_i, x_j} up to degree order-1
+	double errorSymplectic = 0;
+	for(int i = 0; i < 2 * N; i++)
+		for(int j = 0; j < 2 * N; j++)
+		{
+			Polynom d = truncate(X[i] ^ X[j], order - 1);
+			if(j == i + N)
+				d.list[CMonom<N>()] -= Complex(1.0);
+			else if(i == j + N)
+				d.list[CMonom<N>()] += Complex(1.0);
+			errorSymplectic = max(errorSymplectic, maxCoeff(d));
+		}
+
+	cout << "K difference " << errorK << "\n";
+	cout << "Y(X(x))-x " << errorInverse << "\n";
+	cout << "{X_i,X_j}-J_ij " << errorSymplectic << "\n";
+	cout << "time Deprit " << timeDeprit << "s, Dragt-Finn " << timeDragtFinn << "s\n";
+
+	bool ok = errorK < tolerance && errorInverse < tolerance && errorSymplectic < tolerance;
+	cout << (ok ? "Dragt-Finn normal form checked\n" : "Dragt-Finn normal form check failed\n");
+	return ok ? 0 : 1;
+}
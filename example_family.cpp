@@ -0,0 +1,104 @@
+// Example for NormalForm library
+//
+// Family of Henon-Heiles type hamiltonians with frequency w2 of the second
+// degree of freedom as parameter: all samples are normalized in one batched
+// run and compared with normal forms computed for every sample separately.
+// Samples w2 = 1/2 and w2 = 1 are resonant, their resonant terms stay in K.
+
+#include "stdafx.h"
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <algorithm>
+
+#include "normalform/normalform.h"
+#include "normalform/compose.h"
+#include "normalform/family.h"
+
+
+using namespace normalform;
+using namespace std;
+
+
+const int N = 2;     // number of degree of freedom
+const int order = 7; // normalization order
+const int M = 8;     // number of samples
+
+typedef CPolynom<N>     Polynom;
+typedef CMonomCoeff<N>  Term;
+typedef complex<double> Complex;
+
+// H = (P1^2+Q1^2)/2 + w2*(P2^2+Q2^2)/2 + Q1^2*Q2 - Q2^3/3 in complex coordinates
+Polynom hamiltonian(const double w2)
+{
+	IntPower m1000[] = {1,0,0,0};
+	IntPower m0100[] = {0,1,0,0};
+	IntPower m0010[] = {0,0,1,0};
+	IntPower m0001[] = {0,0,0,1};
+	IntPower m2000[] = {2,0,0,0}, m0200[] = {0,2,0,0}, m0020[] = {0,0,2,0}, m0002[] = {0,0,0,2};
+	IntPower m2100[] = {2,1,0,0}, m0300[] = {0,3,0,0};
+
+	Polynom Hreal = Term(Complex(0.5), m0020) + Term(Complex(0.5*w2), m0002) + Term(Complex(0.5), m2000) + Term(Complex(0.5*w2), m0200)
+		+ Term(Complex(1.0), m2100) + Term(Complex(-1.0/3.0), m0300);
+
+	boost::array<Polynom,2*N> coordinates;
+	coordinates[0] = Term(Complex(sqrt(0.5),0), m1000) + Term(Complex(0,sqrt(0.5)), m0010);
+	coordinates[1] = Term(Complex(sqrt(0.5),0), m0100) + Term(Complex(0,sqrt(0.5)), m0001);
+	coordinates[2] = Term(Complex(0,sqrt(0.5)), m1000) + Term(Complex(sqrt(0.5),0), m0010);
+	coordinates[3] = Term(Complex(0,sqrt(0.5)), m0100) + Term(Complex(sqrt(0.5),0), m0001);
+
+	return compose(Hreal, coordinates, 3);
+}
+
+// max coefficient difference relative to max coefficient of b
+double difference(const Polynom& a, const Polynom& b)
+{
+	Polynom d = a;
+	d -= b;
+	double dmax = 0, bmax = 0;
+	for(Polynom::CMonomMap::const_iterator it = d.list.begin(); it != d.list.end(); ++it)
+		dmax = max(dmax, abs(it->second));
+	for(Polynom::CMonomMap::const_iterator it = b.list.begin(); it != b.list.end(); ++it)
+		bmax = max(bmax, abs(it->second));
+	return bmax > 0 ? dmax / bmax : dmax;
+}
+
+#ifdef _MSC_VER
+int _tmain(int, _TCHAR*[])
+#else
+int main()
+#endif
+{
+	Polynom samples[M];
+	double w2[M];
+	for(int i = 0; i < M; i++)
+	{
+		w2[i] = 0.5 + 0.125 * i;
+		samples[i] = hamiltonian(w2[i]);
+	}
+
+	// batched run, lane i holds sample i
+	NormalForm<N,order,CFamily<M> > family(packFamily<M>(samples));
+	family.normalize();
+
+	double maxdiff = 0;
+	for(int i = 0; i < M; i++)
+	{
+		NormalForm<N,order> NF(samples[i]);
+		NF.normalize();
+
+		double d = 0;
+		for(int n = 0; n < order; n++)
+		{
+			d = max(d, difference(sample(family.K[n], i), NF.K[n]));
+			d = max(d, difference(sample(family.S[n], i), NF.S[n]));
+		}
+		cout << "w2=" << w2[i] << " resonances " << NF.resonances.size() << " difference " << d << "\n";
+		maxdiff = max(maxdiff, d);
+	}
+
+	bool ok = maxdiff < 1e-10;
+	cout << (ok ? "family matches scalar normal forms\n" : "family differs from scalar normal forms\n");
+	return ok ? 0 : 1;
+}
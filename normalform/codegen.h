@@ -0,0 +1,255 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include <algorithm>
+#include <cstring>
+#include <boost/array.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_floating_point.hpp>
+
+#include "normalform/monom.h"
+#include "normalform/polynom.h"
+#include "normalform/normalform.h"
+#include "normalform/compose.h"
+#include "normalform/textio.h"
+
+namespace normalform {
+
+	using boost::array;
+
+	// suffix of literal constants of coefficient type
+	template<class Tfloat>
+	struct literal_suffix
+	{
+		static const char* get()
+		{
+			return "";
+		}
+	};
+
+	template<>
+	struct literal_suffix<float>
+	{
+		static const char* get()
+		{
+			return "f";
+		}
+	};
+
+	template<>
+	struct literal_suffix<long double>
+	{
+		static const char* get()
+		{
+			return "L";
+		}
+	};
+
+	// Writes C++ source with straight-line evaluation of polynoms F_0..F_k-1 of 2N complex
+	// variables, independent of this library. Every monom is computed by one complex
+	// multiplication from a monom of lower degree, so monoms shared by terms and components
+	// are computed once. Coefficients are literal constants, zero real or imaginary parts
+	// are skipped. Generated functions:
+	//   void name(const std::complex<scalar> x[2N], std::complex<scalar> y[k])
+	//   void name_batch(std::size_t count, const scalar* const xr[2N], const scalar* const xi[2N],
+	//                   scalar* const yr[k], scalar* const yi[k])
+	// The batch version takes points in separate arrays of real and imaginary parts, its loop
+	// over points is vectorized (#pragma omp simd, compile with -fopenmp-simd or -fopenmp).
+	// Literals are written for built-in coefficient types only, polynoms with wider
+	// coefficients (CDoubleDouble) have to be converted by convertPolynom first.
+	template<size_t N,class Tfloat=double>
+	class CCodeGenerator
+	{
+		BOOST_STATIC_ASSERT(boost::is_floating_point<Tfloat>::value);
+
+	public:
+		CCodeGenerator(std::ostream& s, const std::string& scalarType = "double")
+			: writer(s), scalar(scalarType)
+		{
+			writer.put("// Generated by normalform, do not edit\n\n#pragma once\n\n#include <complex>\n#include <cstddef>\n\n");
+		}
+
+		void write(const std::string& name, const std::vector<CPolynom<N,Tfloat> >& F)
+		{
+			std::vector<CMonom<N> > monoms;
+			std::map<CMonom<N>,size_t> index;
+			buildMonoms(F, monoms, index);
+
+			const size_t K = F.size();
+			put("inline void ").put(name.c_str()).put("(const std::complex<").put(scalar.c_str()).put("> x[").put(2*N)
+				.put("], std::complex<").put(scalar.c_str()).put("> y[").put(K).put("])\n{\n");
+			for(size_t v = 0; v < 2*N; v++)
+				put("\tconst ").put(scalar.c_str()).put(" x").put(v).put("r = x[").put(v).put("].real(), x").put(v).put("i = x[").put(v).put("].imag();\n");
+			writeBody(F, monoms, index, "\t");
+			for(size_t c = 0; c < K; c++)
+				put("\ty[").put(c).put("] = std::complex<").put(scalar.c_str()).put(">(y").put(c).put("r, y").put(c).put("i);\n");
+			put("}\n\n");
+
+			put("inline void ").put(name.c_str()).put("_batch(std::size_t count, const ").put(scalar.c_str()).put("* const xr[").put(2*N)
+				.put("], const ").put(scalar.c_str()).put("* const xi[").put(2*N).put("], ").put(scalar.c_str()).put("* const yr[").put(K)
+				.put("], ").put(scalar.c_str()).put("* const yi[").put(K).put("])\n{\n");
+			put("\t#pragma omp simd\n\tfor(std::size_t k = 0; k < count; k++)\n\t{\n");
+			for(size_t v = 0; v < 2*N; v++)
+				put("\t\tconst ").put(scalar.c_str()).put(" x").put(v).put("r = xr[").put(v).put("][k], x").put(v).put("i = xi[").put(v).put("][k];\n");
+			writeBody(F, monoms, index, "\t\t");
+			for(size_t c = 0; c < K; c++)
+				put("\t\tyr[").put(c).put("][k] = y").put(c).put("r;\n\t\tyi[").put(c).put("][k] = y").put(c).put("i;\n");
+			put("\t}\n}\n\n");
+			writer.flush();
+		}
+
+		void write(const std::string& name, const CPolynom<N,Tfloat>& F)
+		{
+			write(name, std::vector<CPolynom<N,Tfloat> >(1, F));
+		}
+
+	private:
+		CTextWriter writer;
+		std::string scalar;
+
+		CTextWriter& put(const char* s)
+		{
+			return writer.put(s);
+		}
+		CTextWriter& put(const size_t n)
+		{
+			return writer.put(n);
+		}
+
+		// round-trip literal with suffix of coefficient type, always with a point or exponent
+		CTextWriter& put(const Tfloat x)
+		{
+			char buf[128];
+			char* p = formatFloat(buf, buf + sizeof(buf) - 3, x, 'g', -1);
+			*p = 0;
+			if(!std::strpbrk(buf, ".en"))
+				*p++ = '.';
+			std::strcpy(p, literal_suffix<Tfloat>::get());
+			return writer.put(buf);
+		}
+
+		// monom with one power less, in the first variable with nonzero power
+		static CMonom<N> parent(const CMonom<N>& m, size_t& v)
+		{
+			CMonom<N> p = m;
+			for(v = 0; !p[v]; v++);
+			p[v]--;
+			return p;
+		}
+
+		static bool lessDegree(const CMonom<N>& m1, const CMonom<N>& m2)
+		{
+			size_t d1 = m1.degree(), d2 = m2.degree();
+			return d1 < d2 || (d1 == d2 && m1 < m2);
+		}
+
+		// monoms of all terms and their parents, parents first
+		static void buildMonoms(const std::vector<CPolynom<N,Tfloat> >& F, std::vector<CMonom<N> >& monoms, std::map<CMonom<N>,size_t>& index)
+		{
+			std::map<CMonom<N>,size_t> needed;
+			for(size_t c = 0; c < F.size(); c++)
+				for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = F[c].list.begin(); it != F[c].list.end(); ++it)
+				{
+					CMonom<N> m = it->first;
+					size_t v;
+					while(m.degree() > 1 && needed.insert(std::make_pair(m, 0)).second)
+						m = parent(m, v);
+				}
+			for(typename std::map<CMonom<N>,size_t>::const_iterator it = needed.begin(); it != needed.end(); ++it)
+				monoms.push_back(it->first);
+			std::sort(monoms.begin(), monoms.end(), lessDegree);
+			for(size_t j = 0; j < monoms.size(); j++)
+				index[monoms[j]] = j;
+		}
+
+		// name of real or imaginary part of monom of degree >= 1
+		void putMonom(const CMonom<N>& m, const std::map<CMonom<N>,size_t>& index, const char* part)
+		{
+			if(m.degree() == 1)
+			{
+				size_t v;
+				parent(m, v);
+				put("x").put(v).put(part);
+			}
+			else
+				put("m").put(index.find(m)->second).put(part);
+		}
+
+		// y += c*m for one of real or imaginary part
+		void putTerm(const bool imag, const complex<Tfloat>& coeff, const CMonom<N>& m, const std::map<CMonom<N>,size_t>& index)
+		{
+			// re: cr*mr - ci*mi, im: cr*mi + ci*mr
+			const Tfloat zero = (Tfloat)0;
+			if(m.degree() == 0)
+			{
+				Tfloat a = imag ? coeff.imag() : coeff.real();
+				if(a != zero)
+				{
+					put(" + (");
+					put(a).put(")");
+				}
+				return;
+			}
+			if(coeff.real() != zero)
+			{
+				put(" + (");
+				put(coeff.real()).put(")*");
+				putMonom(m, index, imag ? "i" : "r");
+			}
+			if(coeff.imag() != zero)
+			{
+				put(imag ? " + (" : " - (");
+				put(coeff.imag()).put(")*");
+				putMonom(m, index, imag ? "r" : "i");
+			}
+		}
+
+		void writeBody(const std::vector<CPolynom<N,Tfloat> >& F, const std::vector<CMonom<N> >& monoms, const std::map<CMonom<N>,size_t>& index, const char* indent)
+		{
+			for(size_t j = 0; j < monoms.size(); j++)
+			{
+				size_t v;
+				CMonom<N> p = parent(monoms[j], v);
+				put(indent).put("const ").put(scalar.c_str()).put(" m").put(j).put("r = ");
+				putMonom(p, index, "r");
+				put("*x").put(v).put("r - ");
+				putMonom(p, index, "i");
+				put("*x").put(v).put("i, m").put(j).put("i = ");
+				putMonom(p, index, "r");
+				put("*x").put(v).put("i + ");
+				putMonom(p, index, "i");
+				put("*x").put(v).put("r;\n");
+			}
+
+			for(size_t c = 0; c < F.size(); c++)
+				for(size_t part = 0; part < 2; part++)
+				{
+					put(indent).put("const ").put(scalar.c_str()).put(" y").put(c).put(part ? "i = 0" : "r = 0");
+					for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = F[c].list.begin(); it != F[c].list.end(); ++it)
+						putTerm(part != 0, it->second, it->first, index);
+					put(";\n");
+				}
+		}
+	};
+
+	// Writes prefix_K (normal form), prefix_forward and prefix_backward (transforms), all at eps = 1
+	template<size_t N,size_t order,class Tfloat>
+	void writeNormalFormKernels(std::ostream& stream, NormalForm<N,order,Tfloat>& NF, const std::string& prefix, const std::string& scalarType = "double")
+	{
+		CCodeGenerator<N,Tfloat> generator(stream, scalarType);
+		generator.write(prefix + "_K", sumSerie(NF.K));
+
+		std::vector<CPolynom<N,Tfloat> > X(2*N), Y(2*N);
+		for(size_t i = 0; i < 2*N; i++)
+		{
+			X[i] = sumSerie(NF.getForwardTransform(i));
+			Y[i] = sumSerie(NF.getBackwardTransform(i));
+		}
+		generator.write(prefix + "_forward", X);
+		generator.write(prefix + "_backward", Y);
+	}
+
+} // namespace normalform
\ No newline at end of file
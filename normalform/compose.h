@@ -0,0 +1,156 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <boost/array.hpp>
+
+#include "normalform/monom.h"
+#include "normalform/monomcoeff.h"
+#include "normalform/polynom.h"
+#include "normalform/normalform.h"
+
+namespace normalform {
+
+	using boost::array;
+
+	// Substitution of polynoms sub[i] for variables x_i, terms of degree above maxDegree
+	// are dropped. Terms are nested by variables (multivariate Horner scheme), powers of
+	// substitutions are tabulated once and shared by all composed polynoms.
+	template<size_t N,class Tfloat=double>
+	class CComposer
+	{
+	public:
+		CComposer(const array<CPolynom<N,Tfloat>,2*N>& s, const size_t maxDegree)
+			: sub(s), maxdegree(maxDegree)
+		{
+			CPolynom<N,Tfloat> one;
+			one.list[CMonom<N>()] = (Tfloat)1;
+			for(size_t v = 0; v < 2*N; v++)
+			{
+				// lowest degree in sub[v], powers of zero substitution are never used
+				valuation[v] = maxdegree + 1;
+				for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = sub[v].list.begin(); it != sub[v].list.end(); ++it)
+					valuation[v] = std::min(valuation[v], it->first.degree());
+				powers[v].assign(1, one);
+			}
+		}
+
+		CPolynom<N,Tfloat> operator()(const CPolynom<N,Tfloat>& P)
+		{
+			CPackedPolynom<N,Tfloat> packed(P);
+			CPolynom<N,Tfloat> R;
+			compose(R, packed.terms, 0, packed.terms.size(), 0, maxdegree);
+			R.Simplify();
+			return R;
+		}
+
+	private:
+		array<CPolynom<N,Tfloat>,2*N> sub;
+		size_t maxdegree;
+		array<size_t,2*N> valuation;
+		array<std::vector<CPolynom<N,Tfloat> >,2*N> powers;
+
+		// sub[v]^k up to maxdegree
+		const CPolynom<N,Tfloat>& power(const size_t v, const size_t k)
+		{
+			while(powers[v].size() <= k)
+			{
+				CPolynom<N,Tfloat> p;
+				addTruncatedProduct(p, powers[v].back(), sub[v], (complex<Tfloat>)1, maxdegree);
+				p.Simplify();
+				powers[v].push_back(p);
+			}
+			return powers[v][k];
+		}
+
+		// dest += terms[begin,end) with variables from v on substituted, up to degree budget.
+		// Terms are sorted by monom, so terms in the range share powers of variables below v
+		// and are grouped by power of v.
+		void compose(CPolynom<N,Tfloat>& dest, const std::vector<CMonomCoeff<N,Tfloat> >& terms, const size_t begin, const size_t end, const size_t v, const size_t budget)
+		{
+			if(v == 2*N)
+			{
+				dest.list[CMonom<N>()] += terms[begin].coeff;
+				return;
+			}
+
+			for(size_t b = begin; b < end;)
+			{
+				IntPower e = terms[b].monom[v];
+				size_t g = b + 1;
+				while(g < end && terms[g].monom[v] == e)
+					g++;
+
+				size_t low = e * valuation[v];
+				if(e == 0)
+					compose(dest, terms, b, g, v + 1, budget);
+				else if(low <= budget)
+				{
+					CPolynom<N,Tfloat> R;
+					compose(R, terms, b, g, v + 1, budget - low);
+					addTruncatedProduct(dest, power(v, e), R, (complex<Tfloat>)1, budget);
+				}
+				b = g;
+			}
+		}
+	};
+
+	// P(sub[0], ..., sub[2N-1]) up to maxDegree
+	template<size_t N,class Tfloat>
+	inline CPolynom<N,Tfloat> compose(const CPolynom<N,Tfloat>& P, const array<CPolynom<N,Tfloat>,2*N>& sub, const size_t maxDegree)
+	{
+		CComposer<N,Tfloat> composer(sub, maxDegree);
+		return composer(P);
+	}
+
+	// sum of serie at eps = 1: sum_n H[n]/n!
+	template<class Serie>
+	inline typename Serie::value_type sumSerie(const Serie& H)
+	{
+		typedef typename Serie::value_type polynom_type;
+		typedef typename polynom_type::float_type Tfloat;
+
+		polynom_type R;
+		Tfloat factorial = (Tfloat)1;
+		for(size_t n = 0; n < H.size(); n++)
+		{
+			if(n > 0)
+				factorial *= n;
+			R += H[n] * (complex<Tfloat>)((Tfloat)1 / factorial);
+		}
+		R.Simplify();
+		return R;
+	}
+
+	// F(X_0, ..., X_2N-1) up to maxDegree for transform series X at eps = 1,
+	// maxDegree should not exceed normalization order + 1
+	template<size_t N,class Tfloat,class Serie>
+	inline CPolynom<N,Tfloat> composeSerie(const CPolynom<N,Tfloat>& F, const array<Serie,2*N>& X, const size_t maxDegree)
+	{
+		array<CPolynom<N,Tfloat>,2*N> sub;
+		for(size_t i = 0; i < 2*N; i++)
+			sub[i] = sumSerie(X[i]);
+		return compose(F, sub, maxDegree);
+	}
+
+	// F with variables replaced by forward transforms of normal form
+	template<size_t N,size_t order,class Tfloat>
+	inline CPolynom<N,Tfloat> composeForward(NormalForm<N,order,Tfloat>& NF, const CPolynom<N,Tfloat>& F, const size_t maxDegree)
+	{
+		array<typename NormalForm<N,order,Tfloat>::serie,2*N> X;
+		for(size_t i = 0; i < 2*N; i++)
+			X[i] = NF.getForwardTransform(i);
+		return composeSerie(F, X, maxDegree);
+	}
+
+	// F with variables replaced by backward transforms of normal form
+	template<size_t N,size_t order,class Tfloat>
+	inline CPolynom<N,Tfloat> composeBackward(NormalForm<N,order,Tfloat>& NF, const CPolynom<N,Tfloat>& F, const size_t maxDegree)
+	{
+		array<typename NormalForm<N,order,Tfloat>::serie,2*N> Y;
+		for(size_t i = 0; i < 2*N; i++)
+			Y[i] = NF.getBackwardTransform(i);
+		return composeSerie(F, Y, maxDegree);
+	}
+
+} // namespace normalform
\ No newline at end of file
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <ostream>
+
+#include "normalform/polynom.h"
+#include "normalform/textio.h"
+
+namespace normalform {
+
+	// Double-double number hi+lo with |lo| <= ulp(hi)/2, about 106 bits of mantissa.
+	// Operations are branch-free error-free transformations of doubles, they use fma
+	// when it is fast in hardware (compile with -mfma). Do not use with -ffast-math.
+	class CDoubleDouble
+	{
+	public:
+		double hi, lo;
+
+		CDoubleDouble() : hi(0), lo(0)
+		{};
+		CDoubleDouble(const double x) : hi(x), lo(0)
+		{};
+		CDoubleDouble(const double h, const double l) : hi(h), lo(l)
+		{};
+
+		// s+e == a+b exactly
+		static inline CDoubleDouble twoSum(const double a, const double b)
+		{
+			double s = a + b;
+			double v = s - a;
+			return CDoubleDouble(s, (a - (s - v)) + (b - v));
+		}
+
+		// s+e == a+b exactly, requires |a| >= |b|
+		static inline CDoubleDouble quickTwoSum(const double a, const double b)
+		{
+			double s = a + b;
+			return CDoubleDouble(s, b - (s - a));
+		}
+
+		// p+e == a*b exactly
+		static inline CDoubleDouble twoProd(const double a, const double b)
+		{
+			double p = a * b;
+#ifdef FP_FAST_FMA
+			return CDoubleDouble(p, fma(a, b, -p));
+#else
+			const double split = 134217729.0; // 2^27+1
+			double t = split * a;
+			double ah = t - (t - a), al = a - ah;
+			t = split * b;
+			double bh = t - (t - b), bl = b - bh;
+			return CDoubleDouble(p, ((ah * bh - p) + ah * bl + al * bh) + al * bl);
+#endif
+		}
+
+		CDoubleDouble operator-() const
+		{
+			return CDoubleDouble(-hi, -lo);
+		}
+
+		CDoubleDouble& operator+=(const CDoubleDouble& b)
+		{
+			CDoubleDouble s = twoSum(hi, b.hi);
+			CDoubleDouble t = twoSum(lo, b.lo);
+			s.lo += t.hi;
+			s = quickTwoSum(s.hi, s.lo);
+			s.lo += t.lo;
+			return *this = quickTwoSum(s.hi, s.lo);
+		}
+
+		CDoubleDouble& operator+=(const double b)
+		{
+			CDoubleDouble s = twoSum(hi, b);
+			s.lo += lo;
+			return *this = quickTwoSum(s.hi, s.lo);
+		}
+
+		CDoubleDouble& operator-=(const CDoubleDouble& b)
+		{
+			return *this += -b;
+		}
+
+		CDoubleDouble& operator-=(const double b)
+		{
+			return *this += -b;
+		}
+
+		CDoubleDouble& operator*=(const CDoubleDouble& b)
+		{
+			CDoubleDouble p = twoProd(hi, b.hi);
+			p.lo += hi * b.lo + lo * b.hi;
+			return *this = quickTwoSum(p.hi, p.lo);
+		}
+
+		CDoubleDouble& operator*=(const double b)
+		{
+			CDoubleDouble p = twoProd(hi, b);
+			p.lo += lo * b;
+			return *this = quickTwoSum(p.hi, p.lo);
+		}
+
+		// long division with three partial quotients
+		CDoubleDouble& operator/=(const CDoubleDouble& b)
+		{
+			double q1 = hi / b.hi;
+			CDoubleDouble r = *this;
+			r -= CDoubleDouble(b) *= q1;
+			double q2 = r.hi / b.hi;
+			r -= CDoubleDouble(b) *= q2;
+			double q3 = r.hi / b.hi;
+			*this = quickTwoSum(q1, q2);
+			return *this += q3;
+		}
+
+		CDoubleDouble& operator/=(const double b)
+		{
+			return *this /= CDoubleDouble(b);
+		}
+
+		double toDouble() const
+		{
+			return hi + lo;
+		}
+
+		long double toLongDouble() const
+		{
+			return (long double)hi + (long double)lo;
+		}
+	};
+
+	inline CDoubleDouble operator+(CDoubleDouble a, const CDoubleDouble& b) { return a += b; }
+	inline CDoubleDouble operator+(CDoubleDouble a, const double b) { return a += b; }
+	inline CDoubleDouble operator+(const double a, CDoubleDouble b) { return b += a; }
+	inline CDoubleDouble operator-(CDoubleDouble a, const CDoubleDouble& b) { return a -= b; }
+	inline CDoubleDouble operator-(CDoubleDouble a, const double b) { return a -= b; }
+	inline CDoubleDouble operator-(const double a, const CDoubleDouble& b) { return -b += a; }
+	inline CDoubleDouble operator*(CDoubleDouble a, const CDoubleDouble& b) { return a *= b; }
+	inline CDoubleDouble operator*(CDoubleDouble a, const double b) { return a *= b; }
+	inline CDoubleDouble operator*(const double a, CDoubleDouble b) { return b *= a; }
+	inline CDoubleDouble operator/(CDoubleDouble a, const CDoubleDouble& b) { return a /= b; }
+	inline CDoubleDouble operator/(CDoubleDouble a, const double b) { return a /= b; }
+	inline CDoubleDouble operator/(const double a, const CDoubleDouble& b) { return CDoubleDouble(a) /= b; }
+
+	inline bool operator==(const CDoubleDouble& a, const CDoubleDouble& b) { return a.hi == b.hi && a.lo == b.lo; }
+	inline bool operator!=(const CDoubleDouble& a, const CDoubleDouble& b) { return !(a == b); }
+	inline bool operator<(const CDoubleDouble& a, const CDoubleDouble& b) { return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo); }
+	inline bool operator>(const CDoubleDouble& a, const CDoubleDouble& b) { return b < a; }
+	inline bool operator<=(const CDoubleDouble& a, const CDoubleDouble& b) { return !(b < a); }
+	inline bool operator>=(const CDoubleDouble& a, const CDoubleDouble& b) { return !(a < b); }
+
+	// found by argument dependent lookup, also from std::complex
+	inline CDoubleDouble abs(const CDoubleDouble& a)
+	{
+		return (a.hi < 0) ? -a : a;
+	}
+
+	inline CDoubleDouble fabs(const CDoubleDouble& a)
+	{
+		return abs(a);
+	}
+
+	// one Newton step from double square root
+	inline CDoubleDouble sqrt(const CDoubleDouble& a)
+	{
+		if(a.hi <= 0)
+			return CDoubleDouble(std::sqrt(a.hi));
+		double x = std::sqrt(a.hi);
+		CDoubleDouble r = a - CDoubleDouble::twoProd(x, x);
+		return CDoubleDouble::quickTwoSum(x, r.hi / (2 * x));
+	}
+
+	inline CDoubleDouble floor(const CDoubleDouble& a)
+	{
+		double h = std::floor(a.hi);
+		if(h != a.hi)
+			return CDoubleDouble(h);
+		return CDoubleDouble::quickTwoSum(h, std::floor(a.lo));
+	}
+
+	template<>
+	struct float_traits<CDoubleDouble>
+	{
+		static CDoubleDouble zero_threshold()
+		{
+			return CDoubleDouble(1e-16);
+		}
+	};
+
+	template<class Tto>
+	struct float_cast<Tto,CDoubleDouble>
+	{
+		static Tto apply(const CDoubleDouble& x)
+		{
+			return (Tto)x.toLongDouble();
+		}
+	};
+
+	template<>
+	struct float_cast<double,CDoubleDouble>
+	{
+		static double apply(const CDoubleDouble& x)
+		{
+			return x.toDouble();
+		}
+	};
+
+	template<>
+	struct float_cast<CDoubleDouble,CDoubleDouble>
+	{
+		static CDoubleDouble apply(const CDoubleDouble& x)
+		{
+			return x;
+		}
+	};
+
+	template<>
+	struct float_cast<CDoubleDouble,long double>
+	{
+		static CDoubleDouble apply(const long double x)
+		{
+			double h = (double)x;
+			return CDoubleDouble(h, (double)(x - h));
+		}
+	};
+
+	// decimal digits of |x|, x = 0.d1d2d3...*10^exp (exp is 1 for zero)
+	inline void decimalDigits(CDoubleDouble x, char* digits, const int count, int& exp)
+	{
+		x = abs(x);
+		exp = 1;
+		if(x.hi == 0)
+		{
+			for(int i = 0; i < count; i++)
+				digits[i] = 0;
+			return;
+		}
+
+		exp = (int)std::floor(std::log10(x.hi)) + 1;
+		CDoubleDouble p = 1, ten = 10;
+		for(int e = std::abs(exp); e; e >>= 1, ten *= ten)
+			if(e & 1)
+				p *= ten;
+		x = (exp > 0) ? x / p : x * p;
+		// x is in [0.1,1) up to rounding of log10
+		if(x.hi >= 1)
+		{
+			x /= 10.0;
+			exp++;
+		}
+		else if(x.hi < 0.1)
+		{
+			x *= 10.0;
+			exp--;
+		}
+
+		for(int i = 0; i < count; i++)
+		{
+			x *= 10.0;
+			CDoubleDouble d = floor(x);
+			int k = (int)d.hi;
+			k = (k < 0) ? 0 : (k > 9) ? 9 : k;
+			digits[i] = (char)k;
+			x -= (double)k;
+		}
+	}
+
+	// rounds digits to count, returns true if rounding carried into a new leading digit
+	inline bool roundDigits(char* digits, const int count, const int total)
+	{
+		if(count >= total || digits[count] < 5)
+			return false;
+		if(count == 0)
+		{
+			digits[0] = 1;
+			return true;
+		}
+		for(int i = count - 1; i >= 0; i--)
+		{
+			if(++digits[i] < 10)
+				return false;
+			digits[i] = 0;
+		}
+		for(int i = count - 1; i > 0; i--)
+			digits[i] = digits[i-1];
+		if(count > 0)
+			digits[0] = 1;
+		return true;
+	}
+
+	// printf-like formatting, found by ADL from formatFloat calls in textio.h;
+	// negative precision gives all significant digits in scientific notation
+	inline char* formatFloat(char* buf, char* end, const CDoubleDouble x, char format, const int precision)
+	{
+		const int maxDigits = 34;
+		char digits[maxDigits + 2];
+		int exp;
+		char* p = buf;
+
+		if(x.hi != x.hi || x.hi - x.hi != 0)
+			return formatFloat(buf, end, x.hi, format, precision);
+
+		if(x.hi < 0 || (x.hi == 0 && 1 / x.hi < 0))
+			*p++ = '-';
+
+		decimalDigits(x, digits, maxDigits + 1, exp);
+		int prec = precision;
+		if(precision < 0)
+		{
+			format = 'e';
+			prec = 32;
+		}
+
+		char style = format;
+		int count; // significant digits
+		if(format == 'f')
+			count = std::min(std::max(exp + prec, 0), maxDigits);
+		else
+		{
+			count = (format == 'e') ? prec + 1 : std::max(prec, 1);
+			count = std::min(count, maxDigits);
+		}
+		if(roundDigits(digits, count, maxDigits + 1))
+		{
+			exp++;
+			if(format == 'f' && count < maxDigits)
+				digits[count++] = 0;
+		}
+		if(format == 'g')
+		{
+			int e10 = exp - 1;
+			style = (e10 < -4 || e10 >= count) ? 'e' : 'f';
+			// %g strips trailing zeros
+			while(count > 1 && digits[count-1] == 0)
+				count--;
+		}
+
+		if(style == 'e')
+		{
+			*p++ = (char)('0' + digits[0]);
+			int frac = (format == 'e') ? prec : count - 1;
+			if(frac > 0)
+				*p++ = '.';
+			for(int i = 1; i <= frac; i++)
+				*p++ = (char)('0' + ((i < count) ? digits[i] : 0));
+			int e10 = exp - 1;
+			*p++ = 'e';
+			*p++ = (e10 < 0) ? '-' : '+';
+			e10 = std::abs(e10);
+			if(e10 >= 100)
+				*p++ = (char)('0' + e10 / 100);
+			*p++ = (char)('0' + e10 / 10 % 10);
+			*p++ = (char)('0' + e10 % 10);
+		}
+		else
+		{
+			int frac = (format == 'f') ? prec : std::max(count - exp, 0);
+			if(exp <= 0)
+				*p++ = '0';
+			for(int i = 0; i < exp; i++)
+				*p++ = (char)('0' + ((i < count) ? digits[i] : 0));
+			if(frac > 0)
+				*p++ = '.';
+			for(int i = 0; i < frac; i++)
+			{
+				int k = exp + i;
+				*p++ = (char)('0' + ((k >= 0 && k < count) ? digits[k] : 0));
+			}
+		}
+		return p;
+	}
+
+	// decimal parsing, found by ADL from readSerie()
+	inline const char* parseFloat(const char* begin, const char* end, CDoubleDouble& x)
+	{
+		const char* p = begin;
+		bool negative = false;
+		if(p < end && (*p == '-' || *p == '+'))
+			negative = (*p++ == '-');
+
+		x = CDoubleDouble(0);
+		int exp = 0;
+		bool digits = false;
+		for(; p < end && *p >= '0' && *p <= '9'; p++, digits = true)
+			(x *= 10.0) += (double)(*p - '0');
+		if(p < end && *p == '.')
+			for(p++; p < end && *p >= '0' && *p <= '9'; p++, exp--, digits = true)
+				(x *= 10.0) += (double)(*p - '0');
+		if(!digits)
+		{
+			// inf, nan
+			double d;
+			const char* stop = parseFloat(begin, end, d);
+			x = CDoubleDouble(d);
+			return stop;
+		}
+		if(p < end && (*p == 'e' || *p == 'E'))
+		{
+			char* stop;
+			long e = strtol(p + 1, &stop, 10);
+			if(stop != p + 1)
+			{
+				exp += (int)e;
+				p = stop;
+			}
+		}
+
+		CDoubleDouble s = 1, ten = 10;
+		for(int e = std::abs(exp); e; e >>= 1, ten *= ten)
+			if(e & 1)
+				s *= ten;
+		x = (exp < 0) ? x / s : x * s;
+		if(negative)
+			x = -x;
+		return p;
+	}
+
+	inline std::ostream& operator<<(std::ostream& stream, const CDoubleDouble& x)
+	{
+		char buf[128];
+		char* p = buf;
+		if((stream.flags() & std::ios::showpos) && !(x.hi < 0))
+			*p++ = '+';
+		std::ios::fmtflags floatfield = stream.flags() & std::ios::floatfield;
+		char format = (floatfield == std::ios::fixed) ? 'f' : (floatfield == std::ios::scientific) ? 'e' : 'g';
+		p = formatFloat(p, buf + sizeof(buf), x, format, (int)stream.precision());
+		return stream.write(buf, p - buf);
+	}
+
+} // namespace normalform
+
+namespace std {
+
+	template<>
+	class numeric_limits<normalform::CDoubleDouble> : public numeric_limits<double>
+	{
+	public:
+		static const int digits = 106;
+		static const int digits10 = 31;
+		static normalform::CDoubleDouble epsilon()
+		{
+			return normalform::CDoubleDouble(4.93038065763132e-32); // 2^-104
+		}
+		static normalform::CDoubleDouble min()
+		{
+			return normalform::CDoubleDouble(numeric_limits<double>::min() * 9007199254740992.0); // 2^53
+		}
+		static normalform::CDoubleDouble max()
+		{
+			return normalform::CDoubleDouble(numeric_limits<double>::max());
+		}
+	};
+
+} // namespace std
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <boost/array.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "normalform/monom.h"
+#include "normalform/monomcoeff.h"
+
+// max size in bytes of dense divisor table, larger tables are filled on demand
+#ifndef NF_DIVISOR_TABLE_SIZE
+#define NF_DIVISOR_TABLE_SIZE (1 << 26)
+#endif
+
+namespace normalform {
+
+	using std::complex;
+
+	// term of K left unnormalized because of small divisor
+	template<size_t N,class Tfloat=double>
+	struct CResonance
+	{
+		size_t order;
+		CMonomCoeff<N,Tfloat> term;
+		complex<Tfloat> divisor;
+	};
+
+	template<class Tfloat>
+	inline bool isResonantDivisor(const complex<Tfloat>& d, const Tfloat& threshold)
+	{
+		using std::abs;
+		return abs(d) < threshold;
+	}
+
+	// c /= d unless d is resonant, false if c is left unchanged.
+	// Coefficient families overload it to mask resonant samples.
+	template<class Tfloat>
+	inline bool divideNonResonant(complex<Tfloat>& c, const complex<Tfloat>& d, const Tfloat& threshold)
+	{
+		if(isResonantDivisor(d, threshold))
+			return false;
+		c /= d;
+		return true;
+	}
+
+	// Small divisors sum_i lambda_i*(k_i-l_i) of monom q^k p^l, indexed by k-l
+	template<size_t N,class Tfloat=double>
+	class CDivisorTable
+	{
+	public:
+		boost::array<complex<Tfloat>,N> lambda;
+		Tfloat threshold;
+
+		// monoms up to maxDegree, divisors below threshold are resonant
+		CDivisorTable(const boost::array<complex<Tfloat>,N>& l, const size_t maxDegree, const Tfloat t = (Tfloat)1e-8)
+			: lambda(l), threshold(t), maxDiff(maxDegree)
+		{
+			const size_t maxSize = NF_DIVISOR_TABLE_SIZE / sizeof(complex<Tfloat>);
+			size_t size = 1;
+			dense = true;
+			for(size_t i = 0; i < N && dense; i++)
+			{
+				size *= 2 * maxDiff + 1;
+				dense = (size <= maxSize);
+			}
+			if(!dense)
+				return;
+
+			table.resize(size);
+			for(size_t idx = 0; idx < size; idx++)
+			{
+				complex<Tfloat> d = (Tfloat)0;
+				size_t r = idx;
+				for(size_t i = N; i > 0; i--)
+				{
+					d += lambda[i-1] * (Tfloat)((int)(r % (2 * maxDiff + 1)) - (int)maxDiff);
+					r /= 2 * maxDiff + 1;
+				}
+				table[idx] = d;
+			}
+		};
+
+		const complex<Tfloat>& operator()(const CMonom<N>& m)
+		{
+			size_t idx = index(m);
+			if(dense)
+				return table[idx];
+
+			typename boost::unordered_map<size_t,complex<Tfloat> >::iterator it = cache.find(idx);
+			if(it != cache.end())
+				return it->second;
+
+			complex<Tfloat> d = (Tfloat)0;
+			for(size_t i = 0; i < N; i++)
+				d += lambda[i] * (Tfloat)((int)m[i] - (int)m[i+N]);
+			return cache[idx] = d;
+		};
+
+		bool isResonant(const complex<Tfloat>& d) const
+		{
+			return isResonantDivisor(d, threshold);
+		};
+
+		// c/d in non-resonant samples, false if all samples are resonant
+		bool divide(complex<Tfloat>& c, const complex<Tfloat>& d) const
+		{
+			return divideNonResonant(c, d, threshold);
+		};
+
+	private:
+		size_t maxDiff;
+		bool dense;
+		std::vector<complex<Tfloat> > table;
+		boost::unordered_map<size_t,complex<Tfloat> > cache;
+
+		size_t index(const CMonom<N>& m) const
+		{
+			size_t idx = 0;
+			for(size_t i = 0; i < N; i++)
+				idx = idx * (2 * maxDiff + 1) + (size_t)((int)m[i] - (int)m[i+N] + (int)maxDiff);
+			return idx;
+		};
+	};
+
+} // namespace normalform
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <complex>
+#include <stdexcept>
+#include <boost/shared_ptr.hpp>
+
+#include "normalform/monom.h"
+#include "normalform/monomcoeff.h"
+#include "normalform/polynom.h"
+#include "normalform/normalform.h"
+
+namespace normalform {
+
+	using std::complex;
+
+	// Polynom with number of degrees of freedom chosen at runtime
+	template<class Tfloat=double>
+	class CDynamicPolynom
+	{
+	public:
+		typedef std::vector<IntPower> CPowers;
+		typedef std::map<CPowers,complex<Tfloat> > CMonomMap;
+
+		size_t N;
+		CMonomMap list;
+
+		CDynamicPolynom(const size_t n = 0) : N(n)
+		{};
+
+		template<size_t M>
+		CDynamicPolynom(const CPolynom<M,Tfloat>& p) : N(M)
+		{
+			for(typename CPolynom<M,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+				list[CPowers(it->first.powers.begin(), it->first.powers.end())] += it->second;
+		};
+
+		// powers has 2N elements: q1..qN, p1..pN
+		CDynamicPolynom<Tfloat>& add(const complex<Tfloat> c, const IntPower powers[])
+		{
+			list[CPowers(powers, powers + 2*N)] += c;
+			return *this;
+		};
+
+		template<size_t M>
+		CPolynom<M,Tfloat> toPolynom() const
+		{
+			if(M != N)
+				throw std::invalid_argument("normalform: dimension mismatch");
+
+			CPolynom<M,Tfloat> p;
+			for(typename CMonomMap::const_iterator it = list.begin(); it != list.end(); ++it)
+				p += CMonomCoeff<M,Tfloat>(it->second, &it->first[0]);
+			return p;
+		};
+	};
+
+	// Normal form with runtime number of degrees of freedom and order
+	template<class Tfloat=double>
+	class DynamicNormalForm
+	{
+	public:
+		typedef std::vector<CDynamicPolynom<Tfloat> > serie;
+
+		virtual ~DynamicNormalForm()
+		{};
+
+		virtual size_t getDimension() const = 0;
+		virtual size_t getOrder() const = 0;
+		virtual void normalize() = 0;
+		virtual serie getH() const = 0;
+		virtual serie getK() const = 0;
+		virtual serie getS() const = 0;
+		virtual serie getForwardTransform(const size_t i) = 0;
+		virtual serie getBackwardTransform(const size_t i) = 0;
+	};
+
+	// compile-time N kernels behind the runtime interface
+	template<size_t N,class Tfloat=double>
+	class DynamicNormalFormImpl : public DynamicNormalForm<Tfloat>
+	{
+	public:
+		typedef typename DynamicNormalForm<Tfloat>::serie serie;
+
+		NormalForm<N,0,Tfloat> NF;
+
+		DynamicNormalFormImpl(const CDynamicPolynom<Tfloat>& p, const size_t order)
+			: NF(p.template toPolynom<N>(), order)
+		{};
+
+		size_t getDimension() const
+		{
+			return N;
+		}
+		size_t getOrder() const
+		{
+			return NF.getOrder();
+		}
+		void normalize()
+		{
+			NF.normalize();
+		}
+		serie getH() const
+		{
+			return convert(NF.H);
+		}
+		serie getK() const
+		{
+			return convert(NF.K);
+		}
+		serie getS() const
+		{
+			return convert(NF.S);
+		}
+		serie getForwardTransform(const size_t i)
+		{
+			return convert(NF.getForwardTransform(i));
+		}
+		serie getBackwardTransform(const size_t i)
+		{
+			return convert(NF.getBackwardTransform(i));
+		}
+
+	private:
+		static serie convert(const typename NormalForm<N,0,Tfloat>::serie& s)
+		{
+			serie d;
+			for(size_t n = 0; n < s.size(); n++)
+				d.push_back(CDynamicPolynom<Tfloat>(s[n]));
+			return d;
+		}
+	};
+
+	// Dispatch to compile-time kernel for p.N (1 to 6 degrees of freedom)
+	template<class Tfloat>
+	boost::shared_ptr<DynamicNormalForm<Tfloat> > createNormalForm(const CDynamicPolynom<Tfloat>& p, const size_t order)
+	{
+		typedef boost::shared_ptr<DynamicNormalForm<Tfloat> > pointer;
+		switch(p.N)
+		{
+		case 1: return pointer(new DynamicNormalFormImpl<1,Tfloat>(p, order));
+		case 2: return pointer(new DynamicNormalFormImpl<2,Tfloat>(p, order));
+		case 3: return pointer(new DynamicNormalFormImpl<3,Tfloat>(p, order));
+		case 4: return pointer(new DynamicNormalFormImpl<4,Tfloat>(p, order));
+		case 5: return pointer(new DynamicNormalFormImpl<5,Tfloat>(p, order));
+		case 6: return pointer(new DynamicNormalFormImpl<6,Tfloat>(p, order));
+		}
+		throw std::invalid_argument("normalform: unsupported number of degrees of freedom");
+	}
+
+} // namespace normalform
\ No newline at end of file
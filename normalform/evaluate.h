@@ -0,0 +1,195 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+#include <algorithm>
+#include <boost/array.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "normalform/monom.h"
+#include "normalform/polynom.h"
+#include "normalform/normalform.h"
+#include "normalform/compose.h"
+
+namespace normalform {
+
+	using std::complex;
+	using boost::array;
+
+	// Evaluation of polynomial map F: C^2N -> C^2N with its Jacobian in one pass.
+	// Distinct monoms of all components are evaluated once from tables of powers,
+	// monom gradients come from prefix and suffix products (forward mode), and every
+	// term updates the value and its Jacobian row.
+	template<size_t N,class Tfloat=double>
+	class CMapEvaluator
+	{
+	public:
+		typedef array<complex<Tfloat>,2*N> point;
+		typedef array<point,2*N> jacobian; // J[i][j] = dF_i/dx_j
+
+		CMapEvaluator(const array<CPolynom<N,Tfloat>,2*N>& F)
+		{
+			maxPower.assign(0);
+			boost::unordered_map<CMonom<N>,size_t> index;
+			std::vector<std::vector<CTerm> > rows;
+			for(size_t c = 0; c < 2*N; c++)
+				for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = F[c].list.begin(); it != F[c].list.end(); ++it)
+				{
+					typename boost::unordered_map<CMonom<N>,size_t>::iterator m = index.find(it->first);
+					if(m == index.end())
+					{
+						m = index.insert(std::make_pair(it->first, monoms.size())).first;
+						monoms.push_back(it->first);
+						rows.push_back(std::vector<CTerm>());
+						for(size_t v = 0; v < 2*N; v++)
+							maxPower[v] = std::max(maxPower[v], (size_t)it->first[v]);
+					}
+					CTerm t = {c, it->second};
+					rows[m->second].push_back(t);
+				}
+
+			// terms of monom j are terms[first[j]..first[j+1])
+			first.push_back(0);
+			for(size_t j = 0; j < rows.size(); j++)
+			{
+				terms.insert(terms.end(), rows[j].begin(), rows[j].end());
+				first.push_back(terms.size());
+			}
+		}
+
+		void evaluate(const point& x, point& value) const
+		{
+			CWorkspace w(maxPower);
+			evaluate(w, x, value, NULL);
+		}
+
+		void evaluate(const point& x, point& value, jacobian& J) const
+		{
+			CWorkspace w(maxPower);
+			evaluate(w, x, value, &J);
+		}
+
+		// batch of points, J may be NULL
+		void evaluate(const std::vector<point>& x, std::vector<point>& values, std::vector<jacobian>* J = NULL) const
+		{
+			values.resize(x.size());
+			if(J)
+				J->resize(x.size());
+
+			#pragma omp parallel
+			{
+				CWorkspace w(maxPower);
+				#pragma omp for
+				for(long k = 0; k < (long)x.size(); k++)
+					evaluate(w, x[k], values[k], J ? &(*J)[k] : NULL);
+			}
+		}
+
+		size_t monomCount() const
+		{
+			return monoms.size();
+		}
+
+	private:
+		struct CTerm
+		{
+			size_t component;
+			complex<Tfloat> coeff;
+		};
+
+		// power tables, reused for points of one thread
+		struct CWorkspace
+		{
+			array<std::vector<complex<Tfloat> >,2*N> powers;
+
+			CWorkspace(const array<size_t,2*N>& maxPower)
+			{
+				for(size_t v = 0; v < 2*N; v++)
+					powers[v].resize(maxPower[v] + 1);
+			}
+		};
+
+		std::vector<CMonom<N> > monoms;
+		std::vector<size_t> first;
+		std::vector<CTerm> terms;
+		array<size_t,2*N> maxPower;
+
+		void evaluate(CWorkspace& w, const point& x, point& value, jacobian* J) const
+		{
+			for(size_t v = 0; v < 2*N; v++)
+			{
+				w.powers[v][0] = (Tfloat)1;
+				for(size_t k = 1; k <= maxPower[v]; k++)
+					w.powers[v][k] = w.powers[v][k-1] * x[v];
+			}
+
+			value.assign((Tfloat)0);
+			if(J)
+				for(size_t c = 0; c < 2*N; c++)
+					(*J)[c].assign((Tfloat)0);
+
+			point grad;
+			for(size_t j = 0; j < monoms.size(); j++)
+			{
+				const CMonom<N>& m = monoms[j];
+
+				// prefix[v] = prod_{u<v} x_u^m_u
+				array<complex<Tfloat>,2*N+1> prefix;
+				prefix[0] = (Tfloat)1;
+				for(size_t v = 0; v < 2*N; v++)
+					prefix[v+1] = m[v] ? prefix[v] * w.powers[v][m[v]] : prefix[v];
+				const complex<Tfloat>& mv = prefix[2*N];
+
+				if(J)
+				{
+					complex<Tfloat> suffix = (Tfloat)1;
+					for(size_t v = 2*N; v > 0; v--)
+					{
+						size_t u = v - 1;
+						if(m[u])
+						{
+							grad[u] = (Tfloat)m[u] * w.powers[u][m[u]-1] * prefix[u] * suffix;
+							suffix *= w.powers[u][m[u]];
+						}
+						else
+							grad[u] = (Tfloat)0;
+					}
+				}
+
+				for(size_t t = first[j]; t < first[j+1]; t++)
+				{
+					const CTerm& term = terms[t];
+					value[term.component] += term.coeff * mv;
+					if(J)
+					{
+						point& row = (*J)[term.component];
+						for(size_t u = 0; u < 2*N; u++)
+							if(m[u])
+								row[u] += term.coeff * grad[u];
+					}
+				}
+			}
+		}
+	};
+
+	// forward transforms of normal form at eps = 1
+	template<size_t N,size_t order,class Tfloat>
+	CMapEvaluator<N,Tfloat> forwardEvaluator(NormalForm<N,order,Tfloat>& NF)
+	{
+		array<CPolynom<N,Tfloat>,2*N> X;
+		for(size_t i = 0; i < 2*N; i++)
+			X[i] = sumSerie(NF.getForwardTransform(i));
+		return CMapEvaluator<N,Tfloat>(X);
+	}
+
+	// backward transforms of normal form at eps = 1
+	template<size_t N,size_t order,class Tfloat>
+	CMapEvaluator<N,Tfloat> backwardEvaluator(NormalForm<N,order,Tfloat>& NF)
+	{
+		array<CPolynom<N,Tfloat>,2*N> Y;
+		for(size_t i = 0; i < 2*N; i++)
+			Y[i] = sumSerie(NF.getBackwardTransform(i));
+		return CMapEvaluator<N,Tfloat>(Y);
+	}
+
+} // namespace normalform
\ No newline at end of file
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <boost/array.hpp>
+
+#include "normalform/monom.h"
+#include "normalform/polynom.h"
+#include "normalform/divisor.h"
+
+namespace normalform {
+
+	using std::complex;
+
+	// Coefficient of a parameter family: M samples of hamiltonians with the same structure
+	// are normalized in one run, e.g. NormalForm<N,order,CFamily<8> >. Monom bookkeeping and
+	// bracket pairing are shared, arithmetic runs over contiguous lanes (loops of fixed length
+	// vectorized by the compiler). Comparisons hold if they hold in all lanes, so adaptive
+	// normalization stops when all samples passed the optimal order. Divisors are checked per
+	// sample: resonant samples keep the term in K and get zero in S.
+	template<size_t M,class Tfloat=double>
+	class CFamily
+	{
+	public:
+		boost::array<Tfloat,M> lanes;
+
+		CFamily()
+		{
+			lanes.assign((Tfloat)0);
+		};
+		CFamily(const Tfloat x)
+		{
+			lanes.assign(x);
+		};
+
+		Tfloat& operator[](const size_t i)
+		{
+			return lanes[i];
+		};
+		const Tfloat& operator[](const size_t i) const
+		{
+			return lanes[i];
+		};
+
+		CFamily<M,Tfloat> operator-() const
+		{
+			CFamily<M,Tfloat> r;
+			for(size_t i = 0; i < M; i++)
+				r.lanes[i] = -lanes[i];
+			return r;
+		};
+
+		CFamily<M,Tfloat>& operator+=(const CFamily<M,Tfloat>& b)
+		{
+			for(size_t i = 0; i < M; i++)
+				lanes[i] += b.lanes[i];
+			return *this;
+		};
+		CFamily<M,Tfloat>& operator-=(const CFamily<M,Tfloat>& b)
+		{
+			for(size_t i = 0; i < M; i++)
+				lanes[i] -= b.lanes[i];
+			return *this;
+		};
+		CFamily<M,Tfloat>& operator*=(const CFamily<M,Tfloat>& b)
+		{
+			for(size_t i = 0; i < M; i++)
+				lanes[i] *= b.lanes[i];
+			return *this;
+		};
+		CFamily<M,Tfloat>& operator/=(const CFamily<M,Tfloat>& b)
+		{
+			for(size_t i = 0; i < M; i++)
+				lanes[i] /= b.lanes[i];
+			return *this;
+		};
+		CFamily<M,Tfloat>& operator*=(const Tfloat b)
+		{
+			for(size_t i = 0; i < M; i++)
+				lanes[i] *= b;
+			return *this;
+		};
+		CFamily<M,Tfloat>& operator/=(const Tfloat b)
+		{
+			for(size_t i = 0; i < M; i++)
+				lanes[i] /= b;
+			return *this;
+		};
+	};
+
+	template<size_t M,class Tfloat>
+	inline CFamily<M,Tfloat> operator+(CFamily<M,Tfloat> a, const CFamily<M,Tfloat>& b) { return a += b; }
+	template<size_t M,class Tfloat>
+	inline CFamily<M,Tfloat> operator-(CFamily<M,Tfloat> a, const CFamily<M,Tfloat>& b) { return a -= b; }
+	template<size_t M,class Tfloat>
+	inline CFamily<M,Tfloat> operator*(CFamily<M,Tfloat> a, const CFamily<M,Tfloat>& b) { return a *= b; }
+	template<size_t M,class Tfloat>
+	inline CFamily<M,Tfloat> operator/(CFamily<M,Tfloat> a, const CFamily<M,Tfloat>& b) { return a /= b; }
+
+	// true if true in all lanes
+	template<size_t M,class Tfloat>
+	inline bool operator==(const CFamily<M,Tfloat>& a, const CFamily<M,Tfloat>& b)
+	{
+		return a.lanes == b.lanes;
+	}
+	template<size_t M,class Tfloat>
+	inline bool operator!=(const CFamily<M,Tfloat>& a, const CFamily<M,Tfloat>& b)
+	{
+		return !(a == b);
+	}
+	template<size_t M,class Tfloat>
+	inline bool operator<(const CFamily<M,Tfloat>& a, const CFamily<M,Tfloat>& b)
+	{
+		bool r = true;
+		for(size_t i = 0; i < M; i++)
+			r = r && (a.lanes[i] < b.lanes[i]);
+		return r;
+	}
+	template<size_t M,class Tfloat>
+	inline bool operator>(const CFamily<M,Tfloat>& a, const CFamily<M,Tfloat>& b)
+	{
+		return b < a;
+	}
+
+	template<size_t M,class Tfloat>
+	inline CFamily<M,Tfloat> abs(const CFamily<M,Tfloat>& a)
+	{
+		CFamily<M,Tfloat> r;
+		for(size_t i = 0; i < M; i++)
+			r.lanes[i] = std::abs(a.lanes[i]);
+		return r;
+	}
+
+	template<size_t M,class Tfloat>
+	inline CFamily<M,Tfloat> sqrt(const CFamily<M,Tfloat>& a)
+	{
+		CFamily<M,Tfloat> r;
+		for(size_t i = 0; i < M; i++)
+			r.lanes[i] = std::sqrt(a.lanes[i]);
+		return r;
+	}
+
+	// lanewise modulus, preferred by overload resolution over std::abs
+	template<size_t M,class Tfloat>
+	inline CFamily<M,Tfloat> abs(const complex<CFamily<M,Tfloat> >& c)
+	{
+		CFamily<M,Tfloat> r;
+		for(size_t i = 0; i < M; i++)
+			r.lanes[i] = std::sqrt(c.real().lanes[i] * c.real().lanes[i] + c.imag().lanes[i] * c.imag().lanes[i]);
+		return r;
+	}
+
+	template<size_t M,class Tfloat>
+	struct float_traits<CFamily<M,Tfloat> >
+	{
+		static CFamily<M,Tfloat> zero_threshold()
+		{
+			return CFamily<M,Tfloat>(float_traits<Tfloat>::zero_threshold());
+		}
+	};
+
+	// zero in all samples
+	template<size_t M,class Tfloat>
+	inline bool isZero(const complex<CFamily<M,Tfloat> > x)
+	{
+		const Tfloat threshold = float_traits<Tfloat>::zero_threshold();
+		bool r = true;
+		for(size_t i = 0; i < M; i++)
+			r = r && (std::abs(x.real().lanes[i]) < threshold) && (std::abs(x.imag().lanes[i]) < threshold);
+		return r;
+	}
+
+	// resonant in some sample
+	template<size_t M,class Tfloat>
+	inline bool isResonantDivisor(const complex<CFamily<M,Tfloat> >& d, const CFamily<M,Tfloat>& threshold)
+	{
+		CFamily<M,Tfloat> a = abs(d);
+		bool r = false;
+		for(size_t i = 0; i < M; i++)
+			r = r || (a.lanes[i] < threshold.lanes[i]);
+		return r;
+	}
+
+	// c/d in non-resonant samples, zero in resonant ones
+	template<size_t M,class Tfloat>
+	inline bool divideNonResonant(complex<CFamily<M,Tfloat> >& c, const complex<CFamily<M,Tfloat> >& d, const CFamily<M,Tfloat>& threshold)
+	{
+		CFamily<M,Tfloat> re, im;
+		bool divided = false;
+		for(size_t i = 0; i < M; i++)
+		{
+			Tfloat dr = d.real().lanes[i], di = d.imag().lanes[i];
+			Tfloat n = dr * dr + di * di;
+			bool resonant = !(n >= threshold.lanes[i] * threshold.lanes[i]);
+			Tfloat cr = c.real().lanes[i], ci = c.imag().lanes[i];
+			re.lanes[i] = resonant ? (Tfloat)0 : (cr * dr + ci * di) / n;
+			im.lanes[i] = resonant ? (Tfloat)0 : (ci * dr - cr * di) / n;
+			divided = divided || !resonant;
+		}
+		c = complex<CFamily<M,Tfloat> >(re, im);
+		return divided;
+	}
+
+	// family with samples[i] in lane i
+	template<size_t M,size_t N,class Tfloat>
+	CPolynom<N,CFamily<M,Tfloat> > packFamily(const CPolynom<N,Tfloat> samples[M])
+	{
+		CPolynom<N,CFamily<M,Tfloat> > p;
+		for(size_t i = 0; i < M; i++)
+			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = samples[i].list.begin(); it != samples[i].list.end(); ++it)
+			{
+				complex<CFamily<M,Tfloat> >& c = p.list[it->first];
+				CFamily<M,Tfloat> re = c.real(), im = c.imag();
+				re.lanes[i] = it->second.real();
+				im.lanes[i] = it->second.imag();
+				c = complex<CFamily<M,Tfloat> >(re, im);
+			}
+		return p;
+	}
+
+	// i-th sample of family
+	template<size_t N,size_t M,class Tfloat>
+	CPolynom<N,Tfloat> sample(const CPolynom<N,CFamily<M,Tfloat> >& p, const size_t i)
+	{
+		CPolynom<N,Tfloat> s;
+		for(typename CPolynom<N,CFamily<M,Tfloat> >::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+			s.list[it->first] = complex<Tfloat>(it->second.real().lanes[i], it->second.imag().lanes[i]);
+		s.Simplify();
+		return s;
+	}
+
+	template<size_t N,size_t M,size_t order,class Tfloat>
+	boost::array<CPolynom<N,Tfloat>,order> sample(const boost::array<CPolynom<N,CFamily<M,Tfloat> >,order>& H, const size_t i)
+	{
+		boost::array<CPolynom<N,Tfloat>,order> s;
+		for(size_t n = 0; n < order; n++)
+			s[n] = sample(H[n], i);
+		return s;
+	}
+
+	template<size_t N,size_t M,class Tfloat>
+	std::vector<CPolynom<N,Tfloat> > sample(const std::vector<CPolynom<N,CFamily<M,Tfloat> > >& H, const size_t i)
+	{
+		std::vector<CPolynom<N,Tfloat> > s(H.size());
+		for(size_t n = 0; n < H.size(); n++)
+			s[n] = sample(H[n], i);
+		return s;
+	}
+
+} // namespace normalform
\ No newline at end of file
@@ -57,6 +57,14 @@ namespace normalform {
 			return powers[j];
 		};
 
+		size_t degree() const
+		{
+			size_t d = 0;
+			for(size_t i = 0; i < 2*N; i++)
+				d += powers[i];
+			return d;
+		};
+
 		CMonom<N>& operator*=(const CMonom<N>& rhs)
 		{
 			for(size_t i = 0; i < 2*N; i++)
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <complex>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
 #include <boost/array.hpp>
+#include <boost/static_assert.hpp>
 
 #include "normalform/monom.h"
 #include "normalform/monomcoeff.h"
 #include "normalform/polynom.h"
+#include "normalform/symmetry.h"
+#include "normalform/divisor.h"
 
 #ifdef NF_LOGGING
 #include <iostream>
@@ -36,35 +42,253 @@ namespace normalform {
 		return b;
 	}
 
+	// serie storage: fixed array for compile-time order, vector for runtime order (order == 0)
+	template<class T,size_t order>
+	struct serie_traits
+	{
+		typedef array<T,order> type;
+		static type create(const size_t)
+		{
+			return type();
+		}
+	};
+
+	template<class T>
+	struct serie_traits<T,0>
+	{
+		typedef std::vector<T> type;
+		static type create(const size_t n)
+		{
+			return type(n);
+		}
+	};
+
+	// Lie series algorithm of normalization: Deprit triangle for the generator serie, or
+	// Dragt-Finn product of exponentials of homogeneous generators (fewer brackets at
+	// high orders). Both give the same K without resonances, the transforms differ but
+	// both map H to K. With resonances the normal form is not unique.
+	enum LieAlgorithm { Deprit, DragtFinn };
+
+	// NormalForm<N,0> takes normalization order at runtime
 	template<size_t N,size_t order,class Tfloat=double>
 	class NormalForm {
 	public:
-		typedef array<CPolynom<N,Tfloat>,order> serie;
+		typedef typename serie_traits<CPolynom<N,Tfloat>,order>::type serie;
 
 		serie H, K, S;
+		CSymmetry<N,Tfloat> symmetry;
+
+		// set by adaptive normalize(): normK[n], normS[n] are norm estimates of K[n]/n!
+		// and S[n-1]/(n-1)!. remainder estimates the error of the truncated serie: the
+		// norm of the dropped order if the terms started growing, otherwise the norm of
+		// the last computed order (terms beyond the maximal order are not estimated)
+		std::vector<Tfloat> normK, normS;
+		Tfloat remainder;
+
+		// terms with |divisor| < divisorThreshold stay in K and are listed in resonances
+		Tfloat divisorThreshold;
+		std::vector<CResonance<N,Tfloat> > resonances;
+
+		LieAlgorithm algorithm;
+
+		// compile-time order only, NormalForm<N,0> needs the runtime order;
+		// throws std::invalid_argument if p is not invariant under sym
+		NormalForm(CPolynom<N,Tfloat> p, const CSymmetry<N,Tfloat>& sym = CSymmetry<N,Tfloat>())
+			: symmetry(sym)
+		{
+			BOOST_STATIC_ASSERT(order > 0);
+			init(p, order);
+		}
+
+		// runtime order >= 1, at most order for compile-time order
+		NormalForm(CPolynom<N,Tfloat> p, const size_t runtimeOrder, const CSymmetry<N,Tfloat>& sym = CSymmetry<N,Tfloat>())
+			: symmetry(sym)
+		{
+			if(runtimeOrder < 1)
+				throw std::invalid_argument("normalform: normalization order must be at least 1");
+			init(p, order ? std::min(runtimeOrder, order) : runtimeOrder);
+		}
+
+		virtual ~NormalForm()
+		{}
+
+		size_t getOrder() const
+		{
+			return norder;
+		}
+
+		void normalize()
+		{
+			normalize(NULL);
+		}
+
+		// Adaptive normalization: stop at optimal truncation order, where norm estimates
+		// of the terms in polydisk |x_i| <= rho[i] start growing. Returns reached order.
+		size_t normalize(const array<Tfloat,2*N>& rho)
+		{
+			normalize(rho.data());
+			return norder;
+		}
+
+		// Mixed precision: orders below lowOrder are computed with Tlow coefficients
+		// (e.g. double) and promoted, higher orders with Tfloat (e.g. CDoubleDouble)
+		template<class Tlow>
+		void normalizeMixed(const size_t lowOrder)
+		{
+			normalizeMixed<Tlow>(lowOrder, NULL);
+		}
+
+		// adaptive, only orders starting from lowOrder are checked for truncation
+		template<class Tlow>
+		size_t normalizeMixed(const size_t lowOrder, const array<Tfloat,2*N>& rho)
+		{
+			normalizeMixed<Tlow>(lowOrder, rho.data());
+			return norder;
+		}
+
+		serie getForwardTransform(const size_t i)
+		{
+			if(symmetry.isTrivial())
+				return computeForwardTransform(i);
+
+			size_t j;
+			const CSymmetryElement<N,Tfloat>& g = symmetry.variableSource(i, j);
+			if(!hasXrep[j])
+			{
+				Xrep[j] = computeForwardTransform(j);
+				hasXrep[j] = true;
+			}
+			return transformImage(g, j, Xrep[j]);
+		}
 
-		NormalForm(CPolynom<N,Tfloat> p)
+		serie getBackwardTransform(const size_t i)
 		{
+			if(symmetry.isTrivial())
+				return computeBackwardTransform(i);
+
+			size_t j;
+			const CSymmetryElement<N,Tfloat>& g = symmetry.variableSource(i, j);
+			if(!hasYrep[j])
+			{
+				Yrep[j] = computeBackwardTransform(j);
+				hasYrep[j] = true;
+			}
+			return transformImage(g, j, Yrep[j]);
+		}
+
+	protected:
+		template<size_t,size_t,class> friend class NormalForm;
+		typedef typename serie_traits<serie,order>::type triangle;
+
+		size_t norder, maxorder;
+
+		// transforms of orbit representative variables
+		array<serie,2*N> Xrep, Yrep;
+		array<bool,2*N> hasXrep, hasYrep;
+
+		void init(const CPolynom<N,Tfloat>& p, const size_t n)
+		{
+			norder = maxorder = n;
+			remainder = (Tfloat)0;
+			divisorThreshold = (Tfloat)1e-8;
+			algorithm = Deprit;
+			H = newSerie();
+			K = newSerie();
+			S = newSerie();
+			hasXrep.assign(false);
+			hasYrep.assign(false);
+
 			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
 			{
 				int m_order = -2;
 				for(size_t i = 0; i < 2*N; i++)
 					m_order += it->first[i];
-				if(m_order >= 0 && m_order < order)
+				if(m_order >= 0 && (size_t)m_order < norder)
 					H[m_order] += CMonomCoeff<N,Tfloat>(it);
 			}
+
+			for(size_t n = 0; n < norder; n++)
+				if(!symmetry.isInvariant(H[n]))
+					throw std::invalid_argument("normalform: hamiltonian is not invariant under the symmetry group");
 		}
 
-		void normalize()
+		void normalize(const Tfloat* rho)
+		{
+			triangle L = newTriangle();
+			K = newSerie();
+			S = newSerie();
+			resonances.clear();
+			normalize(rho, 1, L);
+		}
+
+		template<class Tlow>
+		void normalizeMixed(const size_t lowOrder, const Tfloat* rho)
+		{
+			size_t m = std::min(std::max(lowOrder, (size_t)1), maxorder);
+
+			CPolynom<N,Tlow> Hlow;
+			for(size_t n = 0; n < m; n++)
+				Hlow += convertPolynom<Tlow>(H[n]);
+			// H is checked for invariance already, rounding to Tlow must not fail the check
+			NormalForm<N,0,Tlow> low(Hlow, m);
+			low.symmetry = CSymmetry<N,Tlow>(symmetry);
+			low.divisorThreshold = float_cast<Tlow,Tfloat>::apply(divisorThreshold);
+			low.algorithm = algorithm;
+			typename NormalForm<N,0,Tlow>::triangle Llow = low.newTriangle();
+			low.normalize(NULL, 1, Llow);
+
+			triangle L = newTriangle();
+			K = newSerie();
+			S = newSerie();
+			for(size_t n = 0; n < m; n++)
+			{
+				K[n] = convertPolynom<Tfloat>(low.K[n]);
+				S[n] = convertPolynom<Tfloat>(low.S[n]);
+				for(size_t i = 0; i <= n; i++)
+					L[n][i] = convertPolynom<Tfloat>(Llow[n][i]);
+			}
+			resonances.clear();
+			for(size_t k = 0; k < low.resonances.size(); k++)
+			{
+				CResonance<N,Tfloat> r;
+				r.order = low.resonances[k].order;
+				r.term.monom = low.resonances[k].term.monom;
+				r.term.coeff = convertCoeff<Tfloat>(low.resonances[k].term.coeff);
+				r.divisor = convertCoeff<Tfloat>(low.resonances[k].divisor);
+				resonances.push_back(r);
+			}
+			normalize(rho, m, L);
+		}
+
+		// norm estimates of K[n]/n! and S[n-1]/(n-1)!
+		void estimateNorms(const size_t n, const Tfloat* rho, Tfloat& nK, Tfloat& nS) const
+		{
+			Tfloat factorial = (Tfloat)1;
+			for(size_t i = 2; i <= n; i++)
+				factorial *= i;
+			nK = polydiskNorm(K[n], rho) / factorial;
+			nS = n ? polydiskNorm(S[n-1], rho) * (Tfloat)n / factorial : (Tfloat)0;
+		}
+
+		// Normalize orders from first on, K, S and L are already computed below first
+		void normalize(const Tfloat* rho, const size_t first, triangle& L)
 		{
 			CPolynom<N,Tfloat>& H0 = H[0];
 			array<complex<Tfloat>,N> lambda;
-			array<serie,order> L;
+
+			hasXrep.assign(false);
+			hasYrep.assign(false);
+
+			norder = maxorder;
+			normK.clear();
+			normS.clear();
+			remainder = (Tfloat)0;
 
 			//Get linear part
 #ifdef NF_LOGGING
 			std::cout << "Get frequencies...\n";
 #endif
+			bool diagonal = true;
 			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = H0.list.begin(); it != H0.list.end(); ++it)
 			{
 				CMonomCoeff<N,Tfloat> m(it);
@@ -72,70 +296,264 @@ namespace normalform {
 					if(m.monom[i])
 					{
 						lambda[i] = m.coeff;
+						diagonal = diagonal && (m.monom[i] == 1) && (m.monom[i+N] == 1);
 						break;
 					}
 			}
+			// monom degree in L[n][n] is n+2
+			CDivisorTable<N,Tfloat> divisor(lambda, norder + 1, divisorThreshold);
 
 			//Normalization
 #ifdef NF_LOGGING
 			std::cout << "Normalization...\n";
 #endif
-			L[0][0] = H[0];
 			K[0] = H[0];
-			for(size_t n = 1; n < order; n++)
+			for(size_t n = 0; rho && n < first; n++)
+			{
+				Tfloat nK, nS;
+				estimateNorms(n, rho, nK, nS);
+				normK.push_back(nK);
+				normS.push_back(nS);
+			}
+			if(first > 1)
+				publish(first - 1, false);
+
+			if(algorithm == DragtFinn)
+				normalizeDragtFinn(rho, first, divisor);
+			else
+				normalizeDeprit(rho, first, L, divisor, diagonal);
+			if(rho && norder == maxorder && !normK.empty())
+				remainder = normK.back() + normS.back();
+			publish(norder, true);
+		}
+
+		void normalizeDeprit(const Tfloat* rho, const size_t first, triangle& L, CDivisorTable<N,Tfloat>& divisor, const bool diagonal)
+		{
+			serie Hr = newSerie(); // H, L and K are kept reduced to orbit representatives
+			for(size_t n = 0; n < norder; n++)
+				Hr[n] = symmetry.reduce(H[n]);
+
+			L[0][0] = Hr[0];
+			beginRows(L, first);
+
+			for(size_t n = first; n < norder; n++)
 			{
 #ifdef NF_LOGGING
 				std::cout << n << "-th order (" << (n+2) << "-th in H)\n";
 #endif
-				L[n][0] = H[n];
-				for(size_t i = 1; i <= n; i++)
+				computeRow(L, Hr, n);
+				CPolynom<N,Tfloat> Sn;
+				for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = L[n][n].list.begin(); it != L[n][n].list.end(); ++it)
 				{
-					L[n][i] = L[n][i-1];
-					for(size_t k = 0; k <= n-i; k++)
+					CMonomCoeff<N,Tfloat> f(it);
+
+					const complex<Tfloat>& res = divisor(f.monom);
+					if(divisor.isResonant(res))
 					{
-						//L[n][i] += (complex<Tfloat>)C(n-i,k) * (L[n-1-k][i-1] ^ S[k]);
-						CPolynom<N,Tfloat> LS = L[n-1-k][i-1] ^ S[k];
-						LS *= (complex<Tfloat>)C(n-i,k);
-						L[n][i] += LS;
+						CResonance<N,Tfloat> r = {n, f, res};
+						resonances.push_back(r);
 					}
+					if(divisor.divide(f.coeff, res))
+						Sn += f;
 				}
-				K[n] = L[n][n];
-				for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = K[n].list.begin(); it != K[n].list.end(); ++it)
+				S[n-1] = symmetry.expand(Sn);
+
+				// {H0,S} for diagonal H0 is -divisor*S
+				CPolynom<N,Tfloat> dL;
+				if(diagonal)
 				{
-					CMonomCoeff<N,Tfloat> f(it);
+					for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = Sn.list.begin(); it != Sn.list.end(); ++it)
+						dL.list[it->first] = - divisor(it->first) * it->second;
+				}
+				else
+					dL = symmetry.bracket(Hr[0], S[n-1]);
+				finishRow(L, n, dL);
+				K[n] = symmetry.expand(L[n][n]);
 
-					complex<Tfloat> res = 0;
-					for(size_t i = 0; i < N; i++)
-						res += lambda[i] * (complex<Tfloat>)(f.monom[i] - f.monom[i+N]);
+				if(rho && truncateAt(n, rho))
+					break;
+				publish(n, false);
+			}
+		}
 
-					if(!isZero(res))
+		// Dragt-Finn: G = H is transformed by exp(L_g) for homogeneous g of degree n+2
+		// removing the non-resonant part of G[n], order by order. G and K have eps
+		// scaling, S[n-1] = n!*g as for Deprit generators. Works on expanded polynoms
+		// (symmetry is not used for reduction).
+		void normalizeDragtFinn(const Tfloat* rho, const size_t first, CDivisorTable<N,Tfloat>& divisor)
+		{
+			serie G = H;
+			Tfloat factorial = (Tfloat)1;
+			for(size_t n = 1; n < first; n++)
+			{
+				factorial *= n;
+				applyExp(G, S[n-1] * (complex<Tfloat>)((Tfloat)1 / factorial), n, norder);
+			}
+
+			for(size_t n = first; n < norder; n++)
+			{
+#ifdef NF_LOGGING
+				std::cout << n << "-th order (" << (n+2) << "-th in H)\n";
+#endif
+				factorial *= n;
+				CPolynom<N,Tfloat> Sn;
+				for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = G[n].list.begin(); it != G[n].list.end(); ++it)
+				{
+					CMonomCoeff<N,Tfloat> f(it);
+
+					const complex<Tfloat>& res = divisor(f.monom);
+					if(divisor.isResonant(res))
 					{
-						f.coeff /= res;
-						S[n-1] += f;
+						CResonance<N,Tfloat> r = {n, f, res};
+						resonances.push_back(r);
 					}
+					if(divisor.divide(f.coeff, res))
+						Sn += f;
 				}
-				CPolynom<N,Tfloat> dL = H[0] ^ S[n-1];
-				for(size_t i = 1; i <= n; i++)
+				S[n-1] = Sn;
+				applyExp(G, Sn * (complex<Tfloat>)((Tfloat)1 / factorial), n, norder);
+				K[n] = G[n];
+
+				if(rho && truncateAt(n, rho))
+					break;
+				publish(n, false);
+			}
+		}
+
+		// P = exp(L_g)P with L_g f = {f,g} for serie P and g homogeneous of degree
+		// shift+2. Terms of the exponential are computed one after another, orders from
+		// size on are dropped.
+		void applyExp(serie& P, const CPolynom<N,Tfloat>& g, const size_t shift, const size_t size) const
+		{
+			serie T = P;
+			for(size_t k = 1; ; k++)
+			{
+				// T[m] = m!/(m-shift)!/k * {T[m-shift],g}, from the top so that T[m-shift]
+				// is not yet replaced
+				bool nonzero = false;
+				for(size_t m = size; m-- > 0;)
 				{
-					L[n][i] += dL;
-					L[n][i].Simplify();
+					CPolynom<N,Tfloat> U;
+					if(m >= shift && !T[m-shift].list.empty())
+					{
+						Tfloat f = (Tfloat)1 / (Tfloat)k;
+						for(size_t j = m - shift + 1; j <= m; j++)
+							f *= j;
+						addBracket(U, T[m-shift], g, (complex<Tfloat>)f);
+					}
+					U.Simplify();
+					T[m].list.swap(U.list);
+					if(!T[m].list.empty())
+					{
+						P[m] += T[m];
+						nonzero = true;
+					}
 				}
-				K[n] = L[n][n];
+				if(!nonzero)
+					break;
 			}
+			for(size_t m = shift; m < size; m++)
+				P[m].Simplify();
 		}
 
-		serie getForwardTransform(const size_t i)
+		// Adaptive truncation at n-th order: stop when terms start growing, K[n] and
+		// S[n-1] are dropped. Returns true if stopped.
+		bool truncateAt(const size_t n, const Tfloat* rho)
+		{
+			Tfloat nK, nS;
+			estimateNorms(n, rho, nK, nS);
+#ifdef NF_LOGGING
+			std::cout << "|K" << n << "|=" << nK << " |S" << (n-1) << "|=" << nS << "\n";
+#endif
+			// compare with two previous orders, odd and even orders of K often alternate
+			if(n > 2 && nK + nS > normK[n-1] + normS[n-1] && nK + nS > normK[n-2] + normS[n-2])
+			{
+				remainder = nK + nS;
+				K[n].Clear();
+				S[n-1].Clear();
+				norder = n;
+				return true;
+			}
+			normK.push_back(nK);
+			normS.push_back(nS);
+			return false;
+		}
+
+		// rows below first are computed (by normalizeMixed for first > 1)
+		virtual void beginRows(triangle&, const size_t)
+		{}
+
+		// L[n][i] without {H0,S[n-1]}, only L[n][n] is used by the homological equation
+		virtual void computeRow(triangle& L, const serie& Hr, const size_t n)
+		{
+			L[n][0] = Hr[n];
+			for(size_t i = 1; i <= n; i++)
+			{
+				L[n][i] = L[n][i-1];
+				for(size_t k = 0; k <= n-i; k++)
+					L[n][i] += (complex<Tfloat>)C(n-i,k) * symmetry.bracket(L[n-1-k][i-1], S[k]);
+			}
+		}
+
+		// L[n][i] += dL for i >= 1
+		virtual void finishRow(triangle& L, const size_t n, const CPolynom<N,Tfloat>& dL)
+		{
+			for(size_t i = 1; i <= n; i++)
+			{
+				L[n][i] += dL;
+				L[n][i].Simplify();
+			}
+		}
+
+		// S[0..n-1] are final, last is set when normalization is finished
+		virtual void publish(const size_t, const bool)
+		{}
+
+		// wait until transforms of n-th order can be computed, false if n is beyond the order
+		virtual bool waitOrder(const size_t n)
 		{
-			serie X;
+			return n < norder;
+		}
+
+		serie newSerie() const
+		{
+			return serie_traits<CPolynom<N,Tfloat>,order>::create(maxorder);
+		}
+
+		triangle newTriangle() const
+		{
+			triangle T = serie_traits<serie,order>::create(maxorder);
+			for(size_t n = 0; n < maxorder; n++)
+				T[n] = newSerie();
+			return T;
+		}
+
+		serie transformImage(const CSymmetryElement<N,Tfloat>& g, const size_t j, const serie& X) const
+		{
+			serie Xi = newSerie();
+			for(size_t n = 0; n < norder; n++)
+			{
+				Xi[n] = symmetry.apply(g, X[n]);
+				Xi[n] *= (Tfloat)1 / g.phase[j];
+			}
+			return Xi;
+		}
+
+		serie computeForwardTransform(const size_t i)
+		{
+			if(algorithm == DragtFinn)
+				return computeProductTransform(i, false);
+
+			serie X = newSerie();
 			CMonomCoeff<N,Tfloat> mc;
 			mc.coeff = 1;
 			mc.monom[i]++;
 
-			array<serie,order> Xnj;
+			triangle Xnj = newTriangle();
 			X[0] += mc;
 			Xnj[0][0] = X[0];
 
-			for(size_t n = 1; n < order; n++)
+			for(size_t n = 1; waitOrder(n); n++)
 			{
 #ifdef NF_LOGGING
 				std::cout << ".";
@@ -144,12 +562,8 @@ namespace normalform {
 				{
 					Xnj[n][j] = Xnj[n][j-1];
 					for(size_t k = 0; k <= n-j; k++)
-					{
-						//Xnj[n][j] += (complex<Tfloat>)C(n-j,k) * (Xnj[j+k-1][j-1] ^ S[n-(j+k)]);
-						CPolynom<N,Tfloat> XS = Xnj[j+k-1][j-1] ^ S[n-(j+k)];
-						XS *= (complex<Tfloat>)C(n-j,k);
-						Xnj[n][j] += XS;
-					}
+						Xnj[n][j] += (complex<Tfloat>)C(n-j,k) * (Xnj[j+k-1][j-1] ^ S[n-(j+k)]);
+					Xnj[n][j].Simplify();
 				}
 				X[n] = Xnj[n][n];
 				X[n].Simplify();
@@ -157,17 +571,20 @@ namespace normalform {
 			return X;
 		}
 
-		serie getBackwardTransform(const size_t i)
+		serie computeBackwardTransform(const size_t i)
 		{
-			serie Y;
+			if(algorithm == DragtFinn)
+				return computeProductTransform(i, true);
+
+			serie Y = newSerie();
 			CMonomCoeff<N,Tfloat> mc;
 			mc.coeff = 1;
 			mc.monom[i]++;
 
-			array<serie,order> Ynj;
+			triangle Ynj = newTriangle();
 			Y[0] += mc;
 			Ynj[0][0] = Y[0];
-			for(size_t n = 1; n < order; n++)
+			for(size_t n = 1; waitOrder(n); n++)
 			{
 #ifdef NF_LOGGING
 				std::cout << ".";
@@ -176,18 +593,47 @@ namespace normalform {
 				{
 					Ynj[n][j-1] = Ynj[n][j];
 					for(size_t k = 0; k <= n-j; k++)
-					{
-						//Ynj[n][j-1] -= (complex<Tfloat>)C(n-j,k) * (Ynj[n-k-1][j-1] ^ S[k]);
-						CPolynom<N,Tfloat> YS = Ynj[n-k-1][j-1] ^ S[k];
-						YS *= (complex<Tfloat>)C(n-j,k);
-						Ynj[n][j-1] -= YS;
-					}
+						Ynj[n][j-1] -= (complex<Tfloat>)C(n-j,k) * (Ynj[n-k-1][j-1] ^ S[k]);
+					Ynj[n][j-1].Simplify();
 				}
 				Y[n] = Ynj[n][0];
 				Y[n].Simplify();
 			}
 			return Y;
 		}
+
+		// Dragt-Finn transforms: exponentials of g_3, g_4, ... applied to x_i in order
+		// (forward), or of -g in reverse order after the normalization finished (backward)
+		serie computeProductTransform(const size_t i, const bool backward)
+		{
+			serie X = newSerie();
+			CMonomCoeff<N,Tfloat> mc;
+			mc.coeff = 1;
+			mc.monom[i]++;
+			X[0] += mc;
+
+			size_t n = 1;
+			Tfloat factorial = (Tfloat)1;
+			for(; waitOrder(n); n++)
+			{
+#ifdef NF_LOGGING
+				std::cout << ".";
+#endif
+				factorial *= n;
+				if(!backward)
+					applyExp(X, S[n-1] * (complex<Tfloat>)((Tfloat)1 / factorial), n, maxorder);
+			}
+			for(size_t k = n - 1; backward && k > 0; k--)
+			{
+				applyExp(X, S[k-1] * (complex<Tfloat>)((Tfloat)-1 / factorial), k, n);
+				factorial /= k;
+			}
+
+			// orders from n on are not normalized
+			for(size_t m = n; m < maxorder; m++)
+				X[m].Clear();
+			return X;
+		}
 	};
 
 } // namespace normalform
\ No newline at end of file
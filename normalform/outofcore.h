@@ -0,0 +1,415 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <boost/shared_ptr.hpp>
+
+#include "normalform/monom.h"
+#include "normalform/monomcoeff.h"
+#include "normalform/polynom.h"
+#include "normalform/normalform.h"
+
+// number of terms in chunks of polynom files
+#ifndef NF_CHUNK_SIZE
+#define NF_CHUNK_SIZE (1 << 16)
+#endif
+
+// number of terms accumulated in memory before a sorted run is written to disk
+#ifndef NF_SPILL_SIZE
+#define NF_SPILL_SIZE (1 << 22)
+#endif
+
+namespace normalform {
+
+	template<size_t N,class Tfloat> class CChunkReader;
+	template<size_t N,class Tfloat> class CChunkWriter;
+
+	// Polynom on disk: terms sorted by monom in fixed size records, read by chunks
+	// of NF_CHUNK_SIZE terms. The file is removed with the object.
+	template<size_t N,class Tfloat=double>
+	class CChunkFile
+	{
+	public:
+		static const size_t recordSize = 2*N*sizeof(IntPower) + 2*sizeof(Tfloat);
+
+		CChunkFile(const std::string& p) : path(p), count(0)
+		{};
+		~CChunkFile()
+		{
+			std::remove(path.c_str());
+		};
+
+		size_t size() const
+		{
+			return count;
+		};
+		const std::string& getPath() const
+		{
+			return path;
+		};
+
+		void load(CPolynom<N,Tfloat>& p) const
+		{
+			p.Clear();
+			CPolynom<N,Tfloat> chunk;
+			for(CChunkReader<N,Tfloat> reader(*this); reader.read(chunk);)
+				chunk.addTo(p, (complex<Tfloat>)1);
+		};
+
+	private:
+		friend class CChunkReader<N,Tfloat>;
+		friend class CChunkWriter<N,Tfloat>;
+
+		std::string path;
+		size_t count;
+
+		CChunkFile(const CChunkFile<N,Tfloat>&);
+		CChunkFile<N,Tfloat>& operator=(const CChunkFile<N,Tfloat>&);
+	};
+
+	// sequential reading of chunk file
+	template<size_t N,class Tfloat=double>
+	class CChunkReader
+	{
+	public:
+		CChunkReader(const CChunkFile<N,Tfloat>& f) : left(f.count)
+		{
+			if(left)
+			{
+				stream.open(f.path.c_str(), std::ios::in | std::ios::binary);
+				if(!stream)
+					throw std::runtime_error("normalform: cannot open " + f.path);
+			}
+		};
+
+		// next chunk, false at end of file
+		bool read(std::vector<CMonomCoeff<N,Tfloat> >& terms)
+		{
+			const size_t rs = CChunkFile<N,Tfloat>::recordSize;
+			size_t n = std::min(left, (size_t)NF_CHUNK_SIZE);
+			terms.resize(n);
+			if(!n)
+				return false;
+
+			buffer.resize(n * rs);
+			if(!stream.read(&buffer[0], buffer.size()))
+				throw std::runtime_error("normalform: chunk file read error");
+			for(size_t t = 0; t < n; t++)
+			{
+				const char* r = &buffer[t * rs];
+				Tfloat re, im;
+				std::memcpy(&terms[t].monom[0], r, 2*N*sizeof(IntPower));
+				std::memcpy(&re, r + 2*N*sizeof(IntPower), sizeof(Tfloat));
+				std::memcpy(&im, r + 2*N*sizeof(IntPower) + sizeof(Tfloat), sizeof(Tfloat));
+				terms[t].coeff = complex<Tfloat>(re, im);
+			}
+			left -= n;
+			return true;
+		};
+
+		bool read(CPolynom<N,Tfloat>& p)
+		{
+			p.Clear();
+			if(!read(terms))
+				return false;
+			for(size_t t = 0; t < terms.size(); t++)
+				p.list[terms[t].monom] = terms[t].coeff;
+			return true;
+		};
+
+	private:
+		std::ifstream stream;
+		size_t left;
+		std::vector<char> buffer;
+		std::vector<CMonomCoeff<N,Tfloat> > terms;
+	};
+
+	// writes terms in increasing monom order, the file is complete on close()
+	template<size_t N,class Tfloat=double>
+	class CChunkWriter
+	{
+	public:
+		CChunkWriter(CChunkFile<N,Tfloat>& f) : file(f)
+		{
+			file.count = 0;
+			stream.open(file.path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			if(!stream)
+				throw std::runtime_error("normalform: cannot open " + file.path);
+			buffer.reserve(NF_CHUNK_SIZE * CChunkFile<N,Tfloat>::recordSize);
+		};
+		~CChunkWriter()
+		{
+			if(stream.is_open())
+				close();
+		};
+
+		void put(const CMonomCoeff<N,Tfloat>& mc)
+		{
+			const size_t rs = CChunkFile<N,Tfloat>::recordSize;
+			Tfloat re = mc.coeff.real(), im = mc.coeff.imag();
+			size_t t = buffer.size();
+			buffer.resize(t + rs);
+			std::memcpy(&buffer[t], &mc.monom[0], 2*N*sizeof(IntPower));
+			std::memcpy(&buffer[t + 2*N*sizeof(IntPower)], &re, sizeof(Tfloat));
+			std::memcpy(&buffer[t + 2*N*sizeof(IntPower) + sizeof(Tfloat)], &im, sizeof(Tfloat));
+			file.count++;
+			if(buffer.size() >= NF_CHUNK_SIZE * rs)
+				flush();
+		};
+
+		void put(const CPolynom<N,Tfloat>& p)
+		{
+			CPackedPolynom<N,Tfloat> packed(p);
+			for(size_t t = 0; t < packed.terms.size(); t++)
+				put(packed.terms[t]);
+		};
+
+		void close()
+		{
+			flush();
+			stream.close();
+			if(stream.fail())
+				throw std::runtime_error("normalform: chunk file write error");
+		};
+
+	private:
+		CChunkFile<N,Tfloat>& file;
+		std::ofstream stream;
+		std::vector<char> buffer;
+
+		void flush()
+		{
+			if(!buffer.empty() && !stream.write(&buffer[0], buffer.size()))
+				throw std::runtime_error("normalform: chunk file write error");
+			buffer.clear();
+		};
+	};
+
+	// Out-of-core sum: added polynoms are accumulated in memory and written as sorted
+	// runs when NF_SPILL_SIZE terms are exceeded, added files are referenced (they must
+	// live until finish). finish() merges runs, files and the rest in one pass.
+	template<size_t N,class Tfloat=double>
+	class CRunMerger
+	{
+	public:
+		// run files are named prefix.run<k>
+		CRunMerger(const std::string& prefix) : runPrefix(prefix)
+		{};
+
+		template<class E>
+		void add(const CPolynomExpr<E>& e)
+		{
+			sum += e;
+			if(sum.list.size() >= NF_SPILL_SIZE)
+				spill();
+		};
+
+		// f*F
+		void add(const CChunkFile<N,Tfloat>& F, const complex<Tfloat>& f)
+		{
+			inputs.push_back(CInput(&F, f));
+		};
+
+		// merged sum into dest, terms below zero threshold are dropped if simplify is set
+		void finish(CChunkFile<N,Tfloat>& dest, const bool simplify)
+		{
+			std::vector<CSource> sources;
+			for(size_t i = 0; i < inputs.size(); i++)
+				sources.push_back(CSource(*inputs[i].first, inputs[i].second));
+			for(size_t i = 0; i < runs.size(); i++)
+				sources.push_back(CSource(*runs[i], (complex<Tfloat>)1));
+			sources.push_back(CSource(sum));
+
+			typedef std::pair<CMonom<N>,size_t> CHead;
+			std::priority_queue<CHead,std::vector<CHead>,std::greater<CHead> > heads;
+			for(size_t s = 0; s < sources.size(); s++)
+				if(sources[s].valid())
+					heads.push(CHead(sources[s].term().monom, s));
+
+			CChunkWriter<N,Tfloat> writer(dest);
+			while(!heads.empty())
+			{
+				CMonomCoeff<N,Tfloat> mc;
+				mc.monom = heads.top().first;
+				while(!heads.empty() && heads.top().first == mc.monom)
+				{
+					CSource& s = sources[heads.top().second];
+					size_t i = heads.top().second;
+					heads.pop();
+					mc.coeff += s.factor * s.term().coeff;
+					if(s.next())
+						heads.push(CHead(s.term().monom, i));
+				}
+				if(!simplify || !isZero(mc.coeff))
+					writer.put(mc);
+			}
+			writer.close();
+
+			inputs.clear();
+			runs.clear();
+			sum.Clear();
+		};
+
+	private:
+		typedef std::pair<const CChunkFile<N,Tfloat>*,complex<Tfloat> > CInput;
+
+		// sorted terms of a file or of the in-memory sum
+		struct CSource
+		{
+			boost::shared_ptr<CChunkReader<N,Tfloat> > reader;
+			std::vector<CMonomCoeff<N,Tfloat> > terms;
+			size_t pos;
+			complex<Tfloat> factor;
+
+			CSource(const CChunkFile<N,Tfloat>& F, const complex<Tfloat>& f)
+				: reader(new CChunkReader<N,Tfloat>(F)), pos(0), factor(f)
+			{
+				reader->read(terms);
+			}
+			CSource(const CPolynom<N,Tfloat>& p)
+				: terms(CPackedPolynom<N,Tfloat>(p).terms), pos(0), factor((Tfloat)1)
+			{}
+
+			bool valid() const
+			{
+				return pos < terms.size();
+			}
+			const CMonomCoeff<N,Tfloat>& term() const
+			{
+				return terms[pos];
+			}
+			bool next()
+			{
+				if(++pos == terms.size() && reader)
+				{
+					reader->read(terms);
+					pos = 0;
+				}
+				return valid();
+			}
+		};
+
+		std::string runPrefix;
+		std::vector<CInput> inputs;
+		std::vector<boost::shared_ptr<CChunkFile<N,Tfloat> > > runs;
+		CPolynom<N,Tfloat> sum;
+
+		void spill()
+		{
+			std::ostringstream name;
+			name << runPrefix << ".run" << runs.size();
+			runs.push_back(boost::shared_ptr<CChunkFile<N,Tfloat> >(new CChunkFile<N,Tfloat>(name.str())));
+			CChunkWriter<N,Tfloat> writer(*runs.back());
+			writer.put(sum);
+			writer.close();
+			sum.Clear();
+		};
+	};
+
+	// Normal form with the L triangle on disk in directory dir (files are named dir/L<k>,
+	// one normal form per directory). Rows are computed column by column: chunks of
+	// L[m][i-1] are bracketed with resident S[k] and summed by run merging. Only L[n][n] of
+	// the current order stays in memory, besides K and S.
+	template<size_t N,size_t order,class Tfloat=double>
+	class OutOfCoreNormalForm : public NormalForm<N,order,Tfloat>
+	{
+	public:
+		typedef NormalForm<N,order,Tfloat> base;
+		typedef typename base::serie serie;
+
+		OutOfCoreNormalForm(CPolynom<N,Tfloat> p, const std::string& dir, const CSymmetry<N,Tfloat>& sym = CSymmetry<N,Tfloat>())
+			: base(p, sym), directory(dir), fileCount(0)
+		{}
+
+		OutOfCoreNormalForm(CPolynom<N,Tfloat> p, const size_t runtimeOrder, const std::string& dir, const CSymmetry<N,Tfloat>& sym = CSymmetry<N,Tfloat>())
+			: base(p, runtimeOrder, sym), directory(dir), fileCount(0)
+		{}
+
+	protected:
+		typedef typename base::triangle triangle;
+		typedef boost::shared_ptr<CChunkFile<N,Tfloat> > file_ptr;
+
+		std::string directory;
+		size_t fileCount;
+		std::vector<std::vector<file_ptr> > files; // files[n][i] holds L[n][i]
+
+		file_ptr newFile()
+		{
+			std::ostringstream name;
+			name << directory << "/L" << fileCount++;
+			return file_ptr(new CChunkFile<N,Tfloat>(name.str()));
+		}
+
+		file_ptr store(const CPolynom<N,Tfloat>& p)
+		{
+			file_ptr f = newFile();
+			CChunkWriter<N,Tfloat> writer(*f);
+			writer.put(p);
+			writer.close();
+			return f;
+		}
+
+		void beginRows(triangle& L, const size_t first)
+		{
+			files.assign(base::maxorder, std::vector<file_ptr>());
+			for(size_t n = 0; n < first; n++)
+				for(size_t i = 0; i <= n; i++)
+				{
+					files[n].push_back(store(L[n][i]));
+					L[n][i].Clear();
+				}
+		}
+
+		void computeRow(triangle& L, const serie& Hr, const size_t n)
+		{
+			L[n-1][n-1].Clear(); // stored by finishRow
+			files[n].assign(1, store(Hr[n]));
+			for(size_t i = 1; i <= n; i++)
+			{
+				file_ptr f = newFile();
+				CRunMerger<N,Tfloat> sum(f->getPath());
+				sum.add(*files[n][i-1], (complex<Tfloat>)1);
+				for(size_t k = 0; k <= n-i; k++)
+				{
+					complex<Tfloat> c = (complex<Tfloat>)C(n-i,k);
+					CPolynom<N,Tfloat> chunk;
+					for(CChunkReader<N,Tfloat> reader(*files[n-1-k][i-1]); reader.read(chunk);)
+						sum.add(c * base::symmetry.bracket(chunk, base::S[k]));
+				}
+				sum.finish(*f, false);
+				files[n].push_back(f);
+			}
+			files[n][n]->load(L[n][n]);
+		}
+
+		void finishRow(triangle& L, const size_t n, const CPolynom<N,Tfloat>& dL)
+		{
+			for(size_t i = 1; i < n; i++)
+			{
+				file_ptr f = newFile();
+				CRunMerger<N,Tfloat> sum(f->getPath());
+				sum.add(*files[n][i], (complex<Tfloat>)1);
+				sum.add(dL);
+				sum.finish(*f, true);
+				files[n][i] = f;
+			}
+			L[n][n] += dL;
+			L[n][n].Simplify();
+			files[n][n] = store(L[n][n]);
+		}
+
+		void publish(const size_t, const bool last)
+		{
+			if(last)
+				files.clear();
+		}
+	};
+
+} // namespace normalform
\ No newline at end of file
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <boost/array.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/future.hpp>
+
+#include "normalform/normalform.h"
+
+namespace normalform {
+
+	using boost::array;
+
+	// Normal form with transforms computed concurrently with normalization:
+	// n-th order of the transforms starts as soon as S[n-1] is published.
+	// With OpenMP the threads of the polynom kernels (omp_get_max_threads() at start)
+	// are split: every transform worker gets cores/(workers+1) of them, the
+	// normalization the rest. Requires Boost.Thread.
+	template<size_t N,size_t order,class Tfloat=double>
+	class PipelinedNormalForm : public NormalForm<N,order,Tfloat>
+	{
+	public:
+		typedef NormalForm<N,order,Tfloat> base;
+		typedef typename base::serie serie;
+
+		boost::shared_future<void> normalization;
+		array<boost::shared_future<serie>,2*N> forward, backward;
+
+		PipelinedNormalForm(CPolynom<N,Tfloat> p, const CSymmetry<N,Tfloat>& sym = CSymmetry<N,Tfloat>())
+			: base(p, sym), published(0), finished(false), normalizeThreads(1)
+		{}
+
+		PipelinedNormalForm(CPolynom<N,Tfloat> p, const size_t runtimeOrder, const CSymmetry<N,Tfloat>& sym = CSymmetry<N,Tfloat>())
+			: base(p, runtimeOrder, sym), published(0), finished(false), normalizeThreads(1)
+		{}
+
+		~PipelinedNormalForm()
+		{
+			wait();
+		}
+
+		// Start normalization and all 2N forward and backward transforms,
+		// transforms are distributed over workers threads
+		void start(const size_t workers = 2*N)
+		{
+			start(NULL, workers);
+		}
+
+		// adaptive normalization, see NormalForm::normalize(rho)
+		void start(const array<Tfloat,2*N>& r, const size_t workers = 2*N)
+		{
+			rho = r;
+			start(rho.data(), workers);
+		}
+
+		void wait()
+		{
+			threads.join_all();
+		}
+
+	protected:
+		typedef boost::packaged_task<serie> task;
+
+		boost::mutex mutex;
+		boost::condition_variable published_cond;
+		size_t published;
+		bool finished;
+		size_t normalizeThreads;
+		array<Tfloat,2*N> rho;
+		boost::thread_group threads;
+		boost::shared_ptr<boost::packaged_task<void> > normalizeTask;
+		std::vector<boost::shared_ptr<task> > tasks;
+
+		void start(const Tfloat* r, const size_t workers)
+		{
+			wait();
+			published = 0;
+			finished = false;
+
+			normalizeTask.reset(new boost::packaged_task<void>(boost::bind(&PipelinedNormalForm::runNormalize, this, r)));
+			normalization = boost::shared_future<void>(normalizeTask->get_future());
+
+			tasks.clear();
+			for(size_t i = 0; i < 2*N; i++)
+			{
+				tasks.push_back(boost::shared_ptr<task>(new task(boost::bind(&PipelinedNormalForm::computeForwardTransform, this, i))));
+				forward[i] = boost::shared_future<serie>(tasks.back()->get_future());
+				tasks.push_back(boost::shared_ptr<task>(new task(boost::bind(&PipelinedNormalForm::computeBackwardTransform, this, i))));
+				backward[i] = boost::shared_future<serie>(tasks.back()->get_future());
+			}
+
+			size_t running = std::min(workers, tasks.size());
+#ifdef _OPENMP
+			size_t cores = omp_get_max_threads();
+#else
+			size_t cores = 1;
+#endif
+			size_t workerThreads = std::max(cores / (running + 1), (size_t)1);
+			normalizeThreads = std::max(cores - std::min(workerThreads * running, cores), workerThreads);
+
+			threads.create_thread(boost::bind(&boost::packaged_task<void>::operator(), normalizeTask.get()));
+			for(size_t w = 0; w < running; w++)
+				threads.create_thread(boost::bind(&PipelinedNormalForm::runTasks, this, w, workers, workerThreads));
+		}
+
+		// OpenMP team size of parallel kernels called from this thread
+		static void setThreads(const size_t n)
+		{
+#ifdef _OPENMP
+			omp_set_num_threads((int)n);
+#else
+			(void)n;
+#endif
+		}
+
+		// on failure transforms are released with the published orders, the exception
+		// goes to the normalization future
+		void runNormalize(const Tfloat* r)
+		{
+			setThreads(normalizeThreads);
+			try
+			{
+				base::normalize(r);
+			}
+			catch(...)
+			{
+				boost::lock_guard<boost::mutex> lock(mutex);
+				finished = true;
+				published_cond.notify_all();
+				throw;
+			}
+		}
+
+		void runTasks(const size_t first, const size_t step, const size_t threadCount)
+		{
+			setThreads(threadCount);
+			for(size_t t = first; t < tasks.size(); t += step)
+				(*tasks[t])();
+		}
+
+		void publish(const size_t n, const bool last)
+		{
+			boost::lock_guard<boost::mutex> lock(mutex);
+			published = n;
+			finished = last;
+			published_cond.notify_all();
+		}
+
+		bool waitOrder(const size_t n)
+		{
+			boost::unique_lock<boost::mutex> lock(mutex);
+			while(!finished && published < n)
+				published_cond.wait(lock);
+			return !finished || n < published;
+		}
+	};
+
+} // namespace normalform
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include <utility>
 #include <complex>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <limits>
 
 #include <boost/unordered_map.hpp>
 
@@ -13,37 +16,95 @@
 #include <omp.h>
 #endif
 
+// number of terms in operand tiles of product and bracket kernels
+#ifndef NF_TILE_SIZE
+#define NF_TILE_SIZE 256
+#endif
+
+// truncated products with fewer term pairs are computed serially, without packing
+#ifndef NF_SERIAL_PRODUCT
+#define NF_SERIAL_PRODUCT 4096
+#endif
+
 
 namespace normalform {
 
 	using std::complex;
 
+	// coefficients below zero_threshold() are dropped as cancelled,
+	// specialized for coefficient types wider than double
+	template<class Tfloat>
+	struct float_traits
+	{
+		static Tfloat zero_threshold()
+		{
+			return (Tfloat)1e-8;
+		}
+	};
+
+	// conversion between coefficient types, specialized for types without built-in casts
+	template<class Tto,class Tfrom>
+	struct float_cast
+	{
+		static Tto apply(const Tfrom& x)
+		{
+			return (Tto)x;
+		}
+	};
+
+	template<class Tto,class Tfrom>
+	inline complex<Tto> convertCoeff(const complex<Tfrom>& c)
+	{
+		return complex<Tto>(float_cast<Tto,Tfrom>::apply(c.real()), float_cast<Tto,Tfrom>::apply(c.imag()));
+	}
+
 	template<class Tfloat>
 	inline bool isZero(const complex<Tfloat> x)
 	{
-		return (std::abs(x.real()) < (Tfloat)1e-8) && (std::abs(x.imag()) < (Tfloat)1e-8);
+		using std::abs;
+		const Tfloat threshold = float_traits<Tfloat>::zero_threshold();
+		return (abs(x.real()) < threshold) && (abs(x.imag()) < threshold);
 	}
 
 
-	// friend functions
 	template<size_t,class Tfloat> class CPolynom;
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator +(const CPolynom<N,Tfloat>&, const CPolynom<N,Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator +(const CPolynom<N,Tfloat>&, const CMonomCoeff<N,Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator +(const CMonomCoeff<N,Tfloat>&, const CMonomCoeff<N,Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator -(const CPolynom<N,Tfloat>&, const CPolynom<N,Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator -(const CPolynom<N,Tfloat>&, const CMonomCoeff<N,Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator -(const CMonomCoeff<N,Tfloat>&, const CMonomCoeff<N,Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator *(const CPolynom<N,Tfloat>&, const CPolynom<N,Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator *(const CPolynom<N,Tfloat>&, const complex<Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator *(const complex<Tfloat>&, const CPolynom<N,Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator ^(const CPolynom<N,Tfloat>&, const CPolynom<N,Tfloat>&);
-	template<size_t N,class Tfloat> CPolynom<N,Tfloat> operator -(const CPolynom<N,Tfloat>&);
+
+	// Lazy polynom expression: +, -, *, scalar * and ^ build expression nodes that are
+	// evaluated in one pass on construction, assignment or += of a CPolynom.
+	// Polynom operands are kept by reference, so expressions must not outlive them.
+	template<class E>
+	class CPolynomExpr
+	{
+	public:
+		const E& self() const
+		{
+			return static_cast<const E&>(*this);
+		}
+	};
+
+	// operands of expression nodes: polynoms by reference, other nodes by value
+	template<class E>
+	struct expr_operand
+	{
+		typedef const E type;
+	};
+
+	template<size_t N,class Tfloat>
+	struct expr_operand<CPolynom<N,Tfloat> >
+	{
+		typedef const CPolynom<N,Tfloat>& type;
+	};
 
 	template<size_t N,class Tfloat=double>
-	class CPolynom
+	class CPolynom : public CPolynomExpr<CPolynom<N,Tfloat> >
 	{
 	public:
 		typedef boost::unordered_map<CMonom<N>,complex<Tfloat> > CMonomMap;
+		typedef CPolynom<N,Tfloat> polynom_type;
+		typedef Tfloat float_type;
+		static const size_t dimension = N;
+		static const bool simplify = false;
+
 		CMonomMap list;
 
 		CPolynom<N,Tfloat>()
@@ -52,32 +113,53 @@ namespace normalform {
 		{
 			list = p.list;
 		};
+		template<class E>
+		CPolynom<N,Tfloat>(const CPolynomExpr<E>& e)
+		{
+			e.self().addTo(*this, (complex<Tfloat>)1);
+			if(E::simplify)
+				Simplify();
+		};
 		CPolynom<N,Tfloat>& operator =(const CPolynom<N,Tfloat>& p)
 		{
 			list = p.list;
 			return *this;
 		};
+		template<class E>
+		CPolynom<N,Tfloat>& operator =(const CPolynomExpr<E>& e)
+		{
+			CPolynom<N,Tfloat> p(e);
+			list.swap(p.list);
+			return *this;
+		};
 		void Clear()
 		{
 			list.clear();
 		};
 		void Simplify();
-		friend CPolynom<N,Tfloat> operator +<>(const CPolynom<N,Tfloat>& p1, const CPolynom<N,Tfloat>& p2);
-		friend CPolynom<N,Tfloat> operator +<>(const CPolynom<N,Tfloat>& p, const CMonomCoeff<N,Tfloat>& m);
-		friend CPolynom<N,Tfloat> operator +<>(const CMonomCoeff<N,Tfloat>& m1, const CMonomCoeff<N,Tfloat>& m2);
-		friend CPolynom<N,Tfloat> operator -<>(const CPolynom<N,Tfloat>& p1, const CPolynom<N,Tfloat>& p2);
-		friend CPolynom<N,Tfloat> operator -<>(const CPolynom<N,Tfloat>& p, const CMonomCoeff<N,Tfloat>& m);
-		friend CPolynom<N,Tfloat> operator -<>(const CMonomCoeff<N,Tfloat>& m1, const CMonomCoeff<N,Tfloat>& m2);
-		friend CPolynom<N,Tfloat> operator *<>(const CPolynom<N,Tfloat>& p1, const CPolynom<N,Tfloat>& p2);
-		friend CPolynom<N,Tfloat> operator *<>(const CPolynom<N,Tfloat>& p, const complex<Tfloat>& r);
-		friend CPolynom<N,Tfloat> operator *<>(const complex<Tfloat>& r, const CPolynom<N,Tfloat>& p);
-		friend CPolynom<N,Tfloat> operator ^<>(const CPolynom<N,Tfloat>& p1, const CPolynom<N,Tfloat>& p2);
-		friend CPolynom<N,Tfloat> operator -<>(const CPolynom<N,Tfloat>& p);
-		CPolynom<N,Tfloat>& operator +=(const CPolynom<N,Tfloat>& p);
-		CPolynom<N,Tfloat>& operator -=(const CPolynom<N,Tfloat>& p);
+		template<class E>
+		CPolynom<N,Tfloat>& operator +=(const CPolynomExpr<E>& e);
+		template<class E>
+		CPolynom<N,Tfloat>& operator -=(const CPolynomExpr<E>& e);
 		CPolynom<N,Tfloat>& operator +=(const CMonomCoeff<N,Tfloat>& m);
 		CPolynom<N,Tfloat>& operator -=(const CMonomCoeff<N,Tfloat>& m);
 		CPolynom<N,Tfloat>& operator *=(const complex<Tfloat>& r);
+
+		// expression interface: dest += f*(*this)
+		void addTo(CPolynom<N,Tfloat>& dest, const complex<Tfloat>& f) const
+		{
+			for(typename CMonomMap::const_iterator it = list.begin(); it != list.end(); ++it)
+				dest.list[it->first] += f * it->second;
+		};
+		// polynom p with (*this) == f*p, tmp is storage for evaluated expressions
+		const CPolynom<N,Tfloat>& operand(CPolynom<N,Tfloat>&, complex<Tfloat>&) const
+		{
+			return *this;
+		};
+		bool aliases(const CPolynom<N,Tfloat>& p) const
+		{
+			return this == &p;
+		};
 	};
 
 	template<size_t N,class Tfloat>
@@ -96,164 +178,500 @@ namespace normalform {
 	}
 
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator -(const CPolynom<N,Tfloat>& p)
+	template<class E>
+	inline CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator +=(const CPolynomExpr<E>& e)
 	{
-		CPolynom<N,Tfloat> pm(p);
-		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = pm.list.begin(); it != pm.list.end(); ++it)
-			pm.list[it->first] = - pm.list[it->first];
-		return pm;
+		if(e.self().aliases(*this))
+		{
+			CPolynom<N,Tfloat> p;
+			e.self().addTo(p, (complex<Tfloat>)1);
+			p.addTo(*this, (complex<Tfloat>)1);
+		}
+		else
+			e.self().addTo(*this, (complex<Tfloat>)1);
+		return *this;
 	}
 
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator +(const CPolynom<N,Tfloat>& p1, const CPolynom<N,Tfloat>& p2)
+	template<class E>
+	inline CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator -=(const CPolynomExpr<E>& e)
 	{
-		CPolynom<N,Tfloat> p(p1);
-		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p2.list.begin(); it != p2.list.end(); ++it)
-			p.list[it->first] += it->second;
-		return p;
+		if(e.self().aliases(*this))
+		{
+			CPolynom<N,Tfloat> p;
+			e.self().addTo(p, (complex<Tfloat>)1);
+			p.addTo(*this, (complex<Tfloat>)-1);
+		}
+		else
+			e.self().addTo(*this, (complex<Tfloat>)-1);
+		return *this;
 	}
 
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator +=(const CPolynom<N,Tfloat>& p)
+	CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator +=(const CMonomCoeff<N,Tfloat>& mc)
 	{
-		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
-			list[it->first] += it->second;
+		list[mc.monom] += mc.coeff;
 		return *this;
 	}
 
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator +(const CPolynom<N,Tfloat>& p, const CMonomCoeff<N,Tfloat>& mc)
+	inline CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator -=(const CMonomCoeff<N,Tfloat>& mc)
 	{
-		CPolynom<N,Tfloat> p1(p);
-		p1.list[mc.monom] += mc.coeff;
-		return p1;
+		list[mc.monom] -= mc.coeff;
+		return *this;
 	}
 
 	template<size_t N,class Tfloat>
-	CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator +=(const CMonomCoeff<N,Tfloat>& mc)
+	inline CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator *=(const complex<Tfloat>& r)
 	{
-		list[mc.monom] += mc.coeff;
+		if(isZero(r))
+		{
+			Clear();
+			return *this;
+		}
+
+		if(isZero(r-(complex<Tfloat>)1))
+			return *this;
+
+		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = list.begin(); it != list.end(); ++it)
+			list[it->first] = it->second * r;
+
 		return *this;
 	}
 
+	// operand packed in contiguous storage, sorted by monom,
+	// with coefficients split into real and imaginary arrays for the tile kernel
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator +(const CMonomCoeff<N,Tfloat>& m1, const CMonomCoeff<N,Tfloat>& m2)
+	struct CPackedPolynom
 	{
-		CPolynom<N,Tfloat> p;
-		p.list[m1.monom] += m1.coeff;
-		p.list[m2.monom] += m2.coeff;
-		return p;
+		std::vector<CMonomCoeff<N,Tfloat> > terms;
+		std::vector<Tfloat> re, im;
+
+		static bool less(const CMonomCoeff<N,Tfloat>& m1, const CMonomCoeff<N,Tfloat>& m2)
+		{
+			return m1.monom < m2.monom;
+		}
+
+		CPackedPolynom(const CPolynom<N,Tfloat>& p)
+		{
+			terms.reserve(p.list.size());
+			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+				terms.push_back(CMonomCoeff<N,Tfloat>(it));
+			std::sort(terms.begin(), terms.end(), less);
+
+			re.resize(terms.size());
+			im.resize(terms.size());
+			for(size_t i = 0; i < terms.size(); i++)
+			{
+				re[i] = terms[i].coeff.real();
+				im[i] = terms[i].coeff.imag();
+			}
+		}
+
+		// max power of the first variable (terms are sorted by it in descending order)
+		size_t leadPower() const
+		{
+			return terms.empty() ? 0 : terms.front().monom[0];
+		}
+	};
+
+	// c = a*b over a tile of coefficients, componentwise so the loop vectorizes
+	template<class Tfloat>
+	inline void multiplyTile(Tfloat* cre, Tfloat* cim, const complex<Tfloat>& a, const Tfloat* bre, const Tfloat* bim, const size_t n)
+	{
+		const Tfloat are = a.real(), aim = a.imag();
+		#pragma omp simd
+		for(size_t i = 0; i < n; i++)
+		{
+			cre[i] = are * bre[i] - aim * bim[i];
+			cim[i] = are * bim[i] + aim * bre[i];
+		}
 	}
 
-	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator -(const CPolynom<N,Tfloat>& p1, const CPolynom<N,Tfloat>& p2)
+	// Blocked kernel for dest += f*op(F,G): G is processed in tiles of NF_TILE_SIZE terms
+	// streamed against the F terms of each thread, products are written into partitions
+	// by the power of the first variable, so sorted operands give localized writes.
+	// Coefficient products of a tile are computed first in a vectorized pass.
+	template<size_t N,class Tfloat,class Op>
+	inline void addTiled(CPolynom<N,Tfloat>& dest, const CPolynom<N,Tfloat>& F, const CPolynom<N,Tfloat>& G, const complex<Tfloat>& f, Op op)
 	{
-		CPolynom<N,Tfloat> p(p1);
-		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p2.list.begin(); it != p2.list.end(); ++it)
-			p.list[it->first] -= it->second;
-		return p;
+		if(F.list.empty() || G.list.empty())
+			return;
+
+		CPackedPolynom<N,Tfloat> PF(F), PG(G);
+		size_t parts = PF.leadPower() + PG.leadPower() + 1;
+
+		#pragma omp parallel shared(dest)
+		{
+#ifdef _OPENMP
+			size_t thread_count = omp_get_num_threads();
+			size_t thread_num = omp_get_thread_num();
+#else
+			size_t thread_count = 1;
+			size_t thread_num = 0;
+#endif
+			size_t chunk_size = PF.terms.size() / thread_count;
+			size_t begin = thread_num * chunk_size;
+			size_t end = (thread_num == thread_count - 1) ? PF.terms.size() : begin + chunk_size;
+
+			std::vector<CPolynom<N,Tfloat> > Cparts(parts);
+			std::vector<Tfloat> cre(NF_TILE_SIZE), cim(NF_TILE_SIZE);
+			for(size_t tile = 0; tile < PG.terms.size(); tile += NF_TILE_SIZE)
+			{
+				size_t tile_end = std::min(tile + NF_TILE_SIZE, PG.terms.size());
+				for(size_t iF = begin; iF < end; iF++)
+				{
+					multiplyTile(&cre[0], &cim[0], PF.terms[iF].coeff, &PG.re[tile], &PG.im[tile], tile_end - tile);
+					for(size_t iG = tile; iG < tile_end; iG++)
+						op(Cparts, PF.terms[iF].monom, PG.terms[iG].monom, complex<Tfloat>(cre[iG - tile], cim[iG - tile]));
+				}
+			}
+
+			#pragma omp critical
+			for(size_t i = 0; i < parts; i++)
+				Cparts[i].addTo(dest, f);
+		}
 	}
 
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator -=(const CPolynom<N,Tfloat>& p)
+	struct CProductOp
 	{
-		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
-			list[it->first] -= it->second;
-		return *this;
-	}
+		void operator()(std::vector<CPolynom<N,Tfloat> >& Cparts, const CMonom<N>& m1, const CMonom<N>& m2, const complex<Tfloat>& c) const
+		{
+			CMonom<N> m = m1 * m2;
+			Cparts[m[0]].list[m] += c;
+		}
+	};
 
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator -(const CPolynom<N,Tfloat>& p, const CMonomCoeff<N,Tfloat>& mc)
+	struct CBracketOp
 	{
-		CPolynom<N,Tfloat> p1(p);
-		p1.list[mc.monom] -= mc.coeff;
-		return p1;
-	}
+		void operator()(std::vector<CPolynom<N,Tfloat> >& Cparts, const CMonom<N>& mF, const CMonom<N>& mG, const complex<Tfloat>& c) const
+		{
+			CMonom<N> mFG = mF * mG;
+			for(size_t j = 0; j < N; j++)
+			{
+				int diff = mF[j] * mG[j+N] - mG[j] * mF[j+N];
+				if(diff)
+				{
+					CMonom<N> m(mFG);
+					m[j]--;
+					m[j+N]--;
+					Cparts[m[0]].list[m] += c * complex<Tfloat>(diff);
+				}
+			}
+		}
+	};
 
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator -=(const CMonomCoeff<N,Tfloat>& mc)
+	struct CTruncatedProductOp
 	{
-		list[mc.monom] -= mc.coeff;
-		return *this;
-	}
+		size_t maxDegree;
+
+		CTruncatedProductOp(const size_t d) : maxDegree(d)
+		{};
+		void operator()(std::vector<CPolynom<N,Tfloat> >& Cparts, const CMonom<N>& m1, const CMonom<N>& m2, const complex<Tfloat>& c) const
+		{
+			CMonom<N> m = m1 * m2;
+			if(m.degree() <= maxDegree)
+				Cparts[m[0]].list[m] += c;
+		}
+	};
 
+	// dest += f*p1*p2
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator -(const CMonomCoeff<N,Tfloat>& m1, const CMonomCoeff<N,Tfloat>& m2)
+	inline void addProduct(CPolynom<N,Tfloat>& dest, const CPolynom<N,Tfloat>& p1, const CPolynom<N,Tfloat>& p2, const complex<Tfloat>& f)
 	{
-		CPolynom<N,Tfloat> p;
-		p.list[m1.monom] -= m1.coeff;
-		p.list[m2.monom] -= m2.coeff;
-		return p;
+		addTiled(dest, p1, p2, f, CProductOp<N,Tfloat>());
 	}
 
+	// dest += f*p1*p2 without terms of degree above maxDegree, dest must not be p1 or p2
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator *(const CPolynom<N,Tfloat>& p1, const CPolynom<N,Tfloat>& p2)
+	inline void addTruncatedProduct(CPolynom<N,Tfloat>& dest, const CPolynom<N,Tfloat>& p1, const CPolynom<N,Tfloat>& p2, const complex<Tfloat>& f, const size_t maxDegree)
 	{
-		CPolynom<N,Tfloat> p;
-		if(p1.list.empty() || p2.list.empty())
-			return p;
+		if(p1.list.size() * p2.list.size() >= NF_SERIAL_PRODUCT)
+		{
+			addTiled(dest, p1, p2, f, CTruncatedProductOp<N,Tfloat>(maxDegree));
+			return;
+		}
 
 		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it1 = p1.list.begin(); it1 != p1.list.end(); ++it1)
 		{
-			CMonomCoeff<N,Tfloat> mc1(it1);
+			size_t d1 = it1->first.degree();
+			complex<Tfloat> c = f * it1->second;
 			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it2 = p2.list.begin(); it2 != p2.list.end(); ++it2)
-			{
-				CMonomCoeff<N,Tfloat> mc2(it2);
-				p += mc1 * mc2;
-			}
+				if(d1 + it2->first.degree() <= maxDegree)
+					dest.list[it1->first * it2->first] += c * it2->second;
 		}
+	}
 
-		return p;
+	// dest += f*{F,G}
+	template<size_t N,class Tfloat>
+	inline void addBracket(CPolynom<N,Tfloat>& dest, const CPolynom<N,Tfloat>& F, const CPolynom<N,Tfloat>& G, const complex<Tfloat>& f)
+	{
+		//	for(size_t j = 0; j < N; j++)
+		//		dest += f * (diff(F, j) * diff(G, j + N) - diff(G, j) * diff(F, j + N));
+
+#ifdef _OPENMP
+		if(F.list.size() < G.list.size())
+		{
+			addBracket(dest, G, F, -f);
+			return;
+		}
+#endif
+		addTiled(dest, F, G, f, CBracketOp<N,Tfloat>());
 	}
 
+	// single term
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator *(const CPolynom<N,Tfloat>& p, const complex<Tfloat>& r)
+	class CMonomTerm : public CPolynomExpr<CMonomTerm<N,Tfloat> >
 	{
-		if(isZero(r))
-			return CPolynom<N,Tfloat>();
+	public:
+		typedef CPolynom<N,Tfloat> polynom_type;
+		typedef Tfloat float_type;
+		static const bool simplify = false;
 
-		CPolynom<N,Tfloat> p1(p);
-		if(isZero(r - (complex<Tfloat>)1))
-			return p1;
+		CMonomCoeff<N,Tfloat> mc;
 
-		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
-			p1.list[it->first] = it->second * r;
+		CMonomTerm(const CMonomCoeff<N,Tfloat>& m) : mc(m)
+		{};
+		void addTo(polynom_type& dest, const complex<Tfloat>& f) const
+		{
+			dest.list[mc.monom] += f * mc.coeff;
+		};
+		const polynom_type& operand(polynom_type& tmp, complex<Tfloat>&) const
+		{
+			tmp.Clear();
+			tmp += mc;
+			return tmp;
+		};
+		bool aliases(const polynom_type&) const
+		{
+			return false;
+		};
+	};
+
+	// binary node base: A op B
+	template<class E,class E1,class E2>
+	class CPolynomBinary : public CPolynomExpr<E>
+	{
+	public:
+		typedef typename E1::polynom_type polynom_type;
+		typedef typename polynom_type::float_type float_type;
+
+		typename expr_operand<E1>::type a;
+		typename expr_operand<E2>::type b;
+
+		CPolynomBinary(const E1& e1, const E2& e2) : a(e1), b(e2)
+		{};
+		const polynom_type& operand(polynom_type& tmp, complex<float_type>&) const
+		{
+			tmp.Clear();
+			this->self().addTo(tmp, (complex<float_type>)1);
+			return tmp;
+		};
+		bool aliases(const polynom_type& p) const
+		{
+			return a.aliases(p) || b.aliases(p);
+		};
+	};
+
+	template<class E1,class E2>
+	class CPolynomSum : public CPolynomBinary<CPolynomSum<E1,E2>,E1,E2>
+	{
+	public:
+		typedef CPolynomBinary<CPolynomSum<E1,E2>,E1,E2> base;
+		static const bool simplify = false;
+
+		CPolynomSum(const E1& e1, const E2& e2) : base(e1, e2)
+		{};
+		void addTo(typename base::polynom_type& dest, const complex<typename base::float_type>& f) const
+		{
+			this->a.addTo(dest, f);
+			this->b.addTo(dest, f);
+		};
+	};
+
+	template<class E1,class E2>
+	class CPolynomDiff : public CPolynomBinary<CPolynomDiff<E1,E2>,E1,E2>
+	{
+	public:
+		typedef CPolynomBinary<CPolynomDiff<E1,E2>,E1,E2> base;
+		static const bool simplify = false;
+
+		CPolynomDiff(const E1& e1, const E2& e2) : base(e1, e2)
+		{};
+		void addTo(typename base::polynom_type& dest, const complex<typename base::float_type>& f) const
+		{
+			this->a.addTo(dest, f);
+			this->b.addTo(dest, -f);
+		};
+	};
+
+	template<class E1,class E2>
+	class CPolynomProduct : public CPolynomBinary<CPolynomProduct<E1,E2>,E1,E2>
+	{
+	public:
+		typedef CPolynomBinary<CPolynomProduct<E1,E2>,E1,E2> base;
+		static const bool simplify = false;
+
+		CPolynomProduct(const E1& e1, const E2& e2) : base(e1, e2)
+		{};
+		void addTo(typename base::polynom_type& dest, const complex<typename base::float_type>& f) const
+		{
+			typename base::polynom_type t1, t2;
+			complex<typename base::float_type> f1 = (typename base::float_type)1, f2 = (typename base::float_type)1;
+			const typename base::polynom_type& p1 = this->a.operand(t1, f1);
+			const typename base::polynom_type& p2 = this->b.operand(t2, f2);
+			addProduct(dest, p1, p2, f * f1 * f2);
+		};
+	};
+
+	template<class E1,class E2>
+	class CPolynomBracket : public CPolynomBinary<CPolynomBracket<E1,E2>,E1,E2>
+	{
+	public:
+		typedef CPolynomBinary<CPolynomBracket<E1,E2>,E1,E2> base;
+		static const bool simplify = true;
+
+		CPolynomBracket(const E1& e1, const E2& e2) : base(e1, e2)
+		{};
+		void addTo(typename base::polynom_type& dest, const complex<typename base::float_type>& f) const
+		{
+			typename base::polynom_type t1, t2;
+			complex<typename base::float_type> f1 = (typename base::float_type)1, f2 = (typename base::float_type)1;
+			const typename base::polynom_type& p1 = this->a.operand(t1, f1);
+			const typename base::polynom_type& p2 = this->b.operand(t2, f2);
+			addBracket(dest, p1, p2, f * f1 * f2);
+		};
+	};
+
+	// r*A
+	template<class E>
+	class CPolynomScale : public CPolynomExpr<CPolynomScale<E> >
+	{
+	public:
+		typedef typename E::polynom_type polynom_type;
+		typedef typename polynom_type::float_type float_type;
+		static const bool simplify = E::simplify;
+
+		typename expr_operand<E>::type a;
+		complex<float_type> r;
 
-		return p1;
+		CPolynomScale(const E& e, const complex<float_type>& c) : a(e), r(c)
+		{};
+		void addTo(polynom_type& dest, const complex<float_type>& f) const
+		{
+			if(!isZero(r))
+				a.addTo(dest, f * r);
+		};
+		const polynom_type& operand(polynom_type& tmp, complex<float_type>& f) const
+		{
+			f *= r;
+			return a.operand(tmp, f);
+		};
+		bool aliases(const polynom_type& p) const
+		{
+			return a.aliases(p);
+		};
+	};
+
+	template<class E1,class E2>
+	inline CPolynomSum<E1,E2> operator +(const CPolynomExpr<E1>& e1, const CPolynomExpr<E2>& e2)
+	{
+		return CPolynomSum<E1,E2>(e1.self(), e2.self());
 	}
 
-	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator *(const complex<Tfloat>& r, const CPolynom<N,Tfloat>& p)
+	template<class E,size_t N,class Tfloat>
+	inline CPolynomSum<E,CMonomTerm<N,Tfloat> > operator +(const CPolynomExpr<E>& e, const CMonomCoeff<N,Tfloat>& mc)
 	{
-		if(isZero(r))
-			return CPolynom<N,Tfloat>();
+		return CPolynomSum<E,CMonomTerm<N,Tfloat> >(e.self(), mc);
+	}
 
-		CPolynom<N,Tfloat> p1(p);
-		if(isZero(r - (complex<Tfloat>)1))
-			return p1;
+	template<size_t N,class Tfloat>
+	inline CPolynom<N,Tfloat> operator +(const CMonomCoeff<N,Tfloat>& m1, const CMonomCoeff<N,Tfloat>& m2)
+	{
+		CPolynom<N,Tfloat> p;
+		p.list[m1.monom] += m1.coeff;
+		p.list[m2.monom] += m2.coeff;
+		return p;
+	}
 
-		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
-			p1.list[it->first] = it->second * r;
+	template<class E1,class E2>
+	inline CPolynomDiff<E1,E2> operator -(const CPolynomExpr<E1>& e1, const CPolynomExpr<E2>& e2)
+	{
+		return CPolynomDiff<E1,E2>(e1.self(), e2.self());
+	}
 
-		return p1;
+	template<class E,size_t N,class Tfloat>
+	inline CPolynomDiff<E,CMonomTerm<N,Tfloat> > operator -(const CPolynomExpr<E>& e, const CMonomCoeff<N,Tfloat>& mc)
+	{
+		return CPolynomDiff<E,CMonomTerm<N,Tfloat> >(e.self(), mc);
 	}
 
 	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat>& CPolynom<N,Tfloat>::operator *=(const complex<Tfloat>& r)
+	inline CPolynom<N,Tfloat> operator -(const CMonomCoeff<N,Tfloat>& m1, const CMonomCoeff<N,Tfloat>& m2)
 	{
-		if(isZero(r))
-		{
-			Clear();
-			return *this;
-		}
+		CPolynom<N,Tfloat> p;
+		p.list[m1.monom] -= m1.coeff;
+		p.list[m2.monom] -= m2.coeff;
+		return p;
+	}
 
-		if(isZero(r-(complex<Tfloat>)1))
-			return *this;
+	template<class E>
+	inline CPolynomScale<E> operator -(const CPolynomExpr<E>& e)
+	{
+		return CPolynomScale<E>(e.self(), (typename E::float_type)-1);
+	}
 
-		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = list.begin(); it != list.end(); ++it)
-			list[it->first] = it->second * r;
+	template<class E1,class E2>
+	inline CPolynomProduct<E1,E2> operator *(const CPolynomExpr<E1>& e1, const CPolynomExpr<E2>& e2)
+	{
+		return CPolynomProduct<E1,E2>(e1.self(), e2.self());
+	}
 
-		return *this;
+	template<class E>
+	inline CPolynomScale<E> operator *(const CPolynomExpr<E>& e, const complex<typename E::float_type>& r)
+	{
+		return CPolynomScale<E>(e.self(), r);
+	}
+
+	template<class E>
+	inline CPolynomScale<E> operator *(const complex<typename E::float_type>& r, const CPolynomExpr<E>& e)
+	{
+		return CPolynomScale<E>(e.self(), r);
+	}
+
+	template<class E1,class E2>
+	inline CPolynomBracket<E1,E2> operator ^(const CPolynomExpr<E1>& e1, const CPolynomExpr<E2>& e2)
+	{
+		return CPolynomBracket<E1,E2>(e1.self(), e2.self());
+	}
+
+	template<class Tto,size_t N,class Tfrom>
+	inline CPolynom<N,Tto> convertPolynom(const CPolynom<N,Tfrom>& p)
+	{
+		CPolynom<N,Tto> r;
+		for(typename CPolynom<N,Tfrom>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+			r.list[it->first] = convertCoeff<Tto>(it->second);
+		return r;
+	}
+
+	// majorant norm in polydisk |x_i| <= rho[i]
+	template<size_t N,class Tfloat>
+	inline Tfloat polydiskNorm(const CPolynom<N,Tfloat>& p, const Tfloat rho[2*N])
+	{
+		Tfloat norm = (Tfloat)0;
+		for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+		{
+			using std::abs;
+			Tfloat t = abs(it->second);
+			for(size_t i = 0; i < 2*N; i++)
+				for(IntPower j = 0; j < it->first[i]; j++)
+					t *= rho[i];
+			norm += t;
+		}
+		return norm;
 	}
 /*
 	template<size_t N,class Tfloat>
@@ -271,69 +689,4 @@ namespace normalform {
 			return D;
 	}
 */
-	template<size_t N,class Tfloat>
-	inline CPolynom<N,Tfloat> operator ^(const CPolynom<N,Tfloat>& F, const CPolynom<N,Tfloat>& G)
-	{
-		//	CPolynom<N,Tfloat> C;
-		//	for(size_t j = 0; j < N; j++)
-		//		C += diff(F, j) * diff(G, j + N) - diff(G, j) * diff(F, j + N);
-		//	return C;
-
-#ifdef _OPENMP
-		if(F.list.size() < G.list.size())
-		{
-			return -(G^F);
-		}
-#endif
-
-		CPolynom<N,Tfloat> C;
-		#pragma omp parallel shared(C)
-		{
-#ifdef _OPENMP
-			int thread_count = omp_get_num_threads();
-			int thread_num = omp_get_thread_num();
-			size_t chunk_size = F.list.size() / thread_count;
-
-			typename CPolynom<N,Tfloat>::CMonomMap::const_iterator begin = F.list.begin();
-			std::advance(begin, thread_num * chunk_size);
-
-			typename CPolynom<N,Tfloat>::CMonomMap::const_iterator end = begin;
-			if(thread_num == thread_count - 1)
-				end = F.list.end();
-			else
-				std::advance(end, chunk_size);
-#else
-			typename CPolynom<N,Tfloat>::CMonomMap::const_iterator begin = F.list.begin();
-			typename CPolynom<N,Tfloat>::CMonomMap::const_iterator end = F.list.end();
-#endif
-			#pragma omp barrier
-			CPolynom<N,Tfloat> Cchunk;
-			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator itF = begin; itF != end; ++itF)
-			{
-				CMonomCoeff<N,Tfloat> mcF(itF);
-				for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator itG = G.list.begin(); itG != G.list.end(); ++itG)
-				{
-					CMonomCoeff<N,Tfloat> mcG(itG);
-					CMonomCoeff<N,Tfloat> mcFG = mcF*mcG;
-					for(size_t j = 0; j < N; j++)
-					{
-						int diff = mcF.monom[j] * mcG.monom[j+N] - mcG.monom[j] * mcF.monom[j+N];
-						if(diff)
-						{
-							CMonomCoeff<N,Tfloat> mc(mcFG);
-							mc.coeff *= complex<Tfloat>(diff);
-							mc.monom[j]--;
-							mc.monom[j+N]--;
-							Cchunk += mc;
-						}
-					}
-				}
-			}
-			#pragma omp critical
-			C += Cchunk;
-		}
-		C.Simplify();
-		return C;
-	}
-
 } // namespace normalform
\ No newline at end of file
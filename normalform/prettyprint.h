@@ -2,7 +2,10 @@
 
 #include <fstream>
 #include <map>
+#include <vector>
 #include "normalform/normalform.h"
+#include "normalform/dynamic.h"
+#include "normalform/textio.h"
 
 namespace normalform {
 
@@ -27,34 +30,66 @@ namespace normalform {
 		return stream;
 	}
 
+	template<class Tfloat>
+	std::ostream& printCoeff(std::ostream& stream, const complex<Tfloat>& c)
+	{
+		if(c.imag() == 0)
+			stream << std::showpos << c.real() << std::noshowpos;
+		else if(c.real() == 0)
+			stream << std::showpos << c.imag() << std::noshowpos << "*I";
+		else
+			stream << "+(" << c.real() << std::showpos << c.imag() << std::noshowpos << "*I";
+		return stream;
+	}
+
 	template<size_t N,class Tfloat>
 	std::ostream& operator <<(std::ostream& stream, const CPolynom<N,Tfloat>& p)
 	{
-		typedef std::map<CMonom<N>,complex<Tfloat> > ordered_serie;
-		ordered_serie serie(p.list.begin(), p.list.end());
+		CTextWriter writer(stream);
+		writer.put(p);
+		return stream;
+	}
+
+	template<class E>
+	std::ostream& operator <<(std::ostream& stream, const CPolynomExpr<E>& e)
+	{
+		return stream << typename E::polynom_type(e);
+	}
 
-		for(typename ordered_serie::const_iterator it = serie.begin(); it != serie.end(); ++it)
+	template<class Tfloat>
+	std::ostream& operator <<(std::ostream& stream, const CDynamicPolynom<Tfloat>& p)
+	{
+		for(typename CDynamicPolynom<Tfloat>::CMonomMap::const_reverse_iterator it = p.list.rbegin(); it != p.list.rend(); ++it)
 		{
-			if(it->second.imag() == 0)
-				stream << std::showpos << it->second.real() << std::noshowpos;
-			else if(it->second.real() == 0)
-				stream << std::showpos << it->second.imag() << std::noshowpos << "*I";
-			else
-				stream << "+(" << it->second.real() << std::showpos << it->second.imag() << std::noshowpos << "*I";
-
-			stream << " " << it->first;
+			printCoeff(stream, it->second);
+			stream << " ";
+			for(size_t i = 0; i < 2*p.N; i++)
+			{
+				if(it->first[i])
+				{
+					if(i < p.N)
+						stream << "q" << (i+1);
+					else
+						stream << "p" << (i+1-p.N);
+
+					if(it->first[i] > 1)
+						stream << "^" << (size_t)it->first[i];
+
+					stream << " ";
+				}
+			}
 		}
 		return stream;
 	}
 
-	template<size_t N,size_t order,class Tfloat>
-	std::ostream& operator <<(std::ostream& stream, const boost::array<CPolynom<N,Tfloat>,order>& H)
+	template<class Tfloat,class Serie>
+	std::ostream& printSerie(std::ostream& stream, const Serie& H)
 	{
 		std::ios::fmtflags savedFlags(stream.flags());
 		stream << std::noshowpos;
 
 		Tfloat factorial = (Tfloat)1;
-		for(size_t i = 0; i < order; i++)
+		for(size_t i = 0; i < H.size(); i++)
 		{
 			if(i > 0)
 				factorial *= i;
@@ -82,4 +117,26 @@ namespace normalform {
 		return stream;
 	}
 
+	template<size_t N,size_t order,class Tfloat>
+	std::ostream& operator <<(std::ostream& stream, const boost::array<CPolynom<N,Tfloat>,order>& H)
+	{
+		CTextWriter writer(stream);
+		writer.putSerie(H);
+		return stream;
+	}
+
+	template<size_t N,class Tfloat>
+	std::ostream& operator <<(std::ostream& stream, const std::vector<CPolynom<N,Tfloat> >& H)
+	{
+		CTextWriter writer(stream);
+		writer.putSerie(H);
+		return stream;
+	}
+
+	template<class Tfloat>
+	std::ostream& operator <<(std::ostream& stream, const std::vector<CDynamicPolynom<Tfloat> >& H)
+	{
+		return printSerie<Tfloat>(stream, H);
+	}
+
 } // namespace normalform
\ No newline at end of file
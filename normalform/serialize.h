@@ -3,6 +3,7 @@
 #include "normalform/monom.h"
 #include "normalform/monomcoeff.h"
 #include "normalform/polynom.h"
+#include "normalform/ddouble.h"
 
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/complex.hpp>
@@ -13,6 +14,12 @@ namespace boost {
 
 		using namespace normalform;
 
+		template<class Archive>
+		void serialize(Archive &ar, CDoubleDouble &x, const unsigned int version)
+		{
+			ar & x.hi & x.lo;
+		}
+
 		template<class Archive,size_t N>
 		void serialize(Archive &ar, CMonom<N> &m, const unsigned int version)
 		{
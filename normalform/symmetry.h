@@ -0,0 +1,296 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <boost/array.hpp>
+
+#include "normalform/monom.h"
+#include "normalform/monomcoeff.h"
+#include "normalform/polynom.h"
+
+namespace normalform {
+
+	using std::complex;
+
+	// Symplectic monomial action: variable x[k] is replaced by phase[k]*x[perm[k]]
+	template<size_t N,class Tfloat=double>
+	class CSymmetryElement
+	{
+	public:
+		boost::array<size_t,2*N> perm;
+		boost::array<complex<Tfloat>,2*N> phase;
+
+		CSymmetryElement()
+		{
+			for(size_t k = 0; k < 2*N; k++)
+			{
+				perm[k] = k;
+				phase[k] = (Tfloat)1;
+			}
+		};
+
+		template<class T>
+		explicit CSymmetryElement(const CSymmetryElement<N,T>& e)
+			: perm(e.perm)
+		{
+			for(size_t k = 0; k < 2*N; k++)
+				phase[k] = convertCoeff<Tfloat>(e.phase[k]);
+		};
+
+		// image of monom, chi gets the character (coefficient factor)
+		CMonom<N> apply(const CMonom<N>& m, complex<Tfloat>& chi) const
+		{
+			CMonom<N> g;
+			chi = (Tfloat)1;
+			for(size_t k = 0; k < 2*N; k++)
+			{
+				g[perm[k]] = m[k];
+				for(IntPower j = 0; j < m[k]; j++)
+					chi *= phase[k];
+			}
+			return g;
+		};
+
+		// action of this element after h
+		CSymmetryElement<N,Tfloat> operator*(const CSymmetryElement<N,Tfloat>& h) const
+		{
+			CSymmetryElement<N,Tfloat> e;
+			for(size_t k = 0; k < 2*N; k++)
+			{
+				e.perm[k] = perm[h.perm[k]];
+				e.phase[k] = h.phase[k] * phase[h.perm[k]];
+			}
+			return e;
+		};
+
+		bool operator==(const CSymmetryElement<N,Tfloat>& rhs) const
+		{
+			for(size_t k = 0; k < 2*N; k++)
+				if(perm[k] != rhs.perm[k] || !isZero(phase[k] - rhs.phase[k]))
+					return false;
+			return true;
+		};
+	};
+
+	// Finite group of symplectic monomial actions leaving the hamiltonian invariant.
+	// Invariant polynomials are stored by orbit representatives only ("reduced" form)
+	// inside the normalization; the results K and S are expanded again.
+	template<size_t N,class Tfloat=double>
+	class CSymmetry
+	{
+	public:
+		typedef CSymmetryElement<N,Tfloat> Element;
+
+		std::vector<Element> generators;
+		std::vector<Element> group;
+
+		CSymmetry() : group(1)
+		{};
+
+		// same group with other coefficient type
+		template<class T>
+		explicit CSymmetry(const CSymmetry<N,T>& s)
+			: generators(s.generators.begin(), s.generators.end()), group(s.group.begin(), s.group.end())
+		{};
+
+		// permutation of degrees of freedom: q_j -> q_perm[j], p_j -> p_perm[j]
+		void addPermutation(const size_t perm[N])
+		{
+			Element g;
+			for(size_t j = 0; j < N; j++)
+			{
+				g.perm[j] = perm[j];
+				g.perm[j+N] = perm[j] + N;
+			}
+			addGenerator(g);
+		}
+
+		// phase rotation: q_j -> c_j*q_j, p_j -> p_j/c_j (c_j are roots of unity)
+		void addPhase(const complex<Tfloat> c[N])
+		{
+			Element g;
+			for(size_t j = 0; j < N; j++)
+			{
+				g.phase[j] = c[j];
+				g.phase[j+N] = (Tfloat)1 / c[j];
+			}
+			addGenerator(g);
+		}
+
+		void addGenerator(const Element& g)
+		{
+			generators.push_back(g);
+
+			// close the group
+			group.assign(1, Element());
+			for(size_t i = 0; i < group.size(); i++)
+				for(size_t s = 0; s < generators.size(); s++)
+				{
+					Element e = generators[s] * group[i];
+					bool found = false;
+					for(size_t k = 0; k < group.size() && !found; k++)
+						found = (group[k] == e);
+					if(!found)
+						group.push_back(e);
+				}
+		}
+
+		size_t order() const
+		{
+			return group.size();
+		}
+
+		bool isTrivial() const
+		{
+			return group.size() == 1;
+		}
+
+		// Find orbit representative rep of monom m, coefficients of invariant polynom
+		// are related as a[rep] = chi*a[m]. Returns false if m cannot appear in
+		// invariant polynom (some element fixes m with nontrivial character).
+		bool canonical(const CMonom<N>& m, CMonom<N>& rep, complex<Tfloat>& chi, size_t& orbit) const
+		{
+			size_t stab = 0;
+			rep = m;
+			chi = (Tfloat)1;
+			for(size_t i = 0; i < group.size(); i++)
+			{
+				complex<Tfloat> c;
+				CMonom<N> g = group[i].apply(m, c);
+				if(g == m)
+				{
+					if(!isZero(c - (complex<Tfloat>)1))
+						return false;
+					stab++;
+				}
+				else if(g < rep)
+				{
+					rep = g;
+					chi = c;
+				}
+			}
+			orbit = group.size() / stab;
+			return true;
+		}
+
+		// keep orbit representatives of invariant polynom
+		CPolynom<N,Tfloat> reduce(const CPolynom<N,Tfloat>& p) const
+		{
+			if(isTrivial())
+				return p;
+
+			CPolynom<N,Tfloat> r;
+			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+			{
+				CMonom<N> rep;
+				complex<Tfloat> chi;
+				size_t orbit;
+				if(canonical(it->first, rep, chi, orbit) && rep == it->first)
+					r.list[rep] = it->second;
+			}
+			return r;
+		}
+
+		// restore full invariant polynom from orbit representatives
+		CPolynom<N,Tfloat> expand(const CPolynom<N,Tfloat>& r) const
+		{
+			if(isTrivial())
+				return r;
+
+			CPolynom<N,Tfloat> p;
+			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = r.list.begin(); it != r.list.end(); ++it)
+				for(size_t i = 0; i < group.size(); i++)
+				{
+					complex<Tfloat> chi;
+					CMonom<N> m = group[i].apply(it->first, chi);
+					p.list[m] = chi * it->second;
+				}
+			return p;
+		}
+
+		// group average of arbitrary polynom, in reduced form
+		CPolynom<N,Tfloat> project(const CPolynom<N,Tfloat>& p) const
+		{
+			if(isTrivial())
+				return p;
+
+			CPolynom<N,Tfloat> r;
+			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+			{
+				CMonom<N> rep;
+				complex<Tfloat> chi;
+				size_t orbit;
+				if(canonical(it->first, rep, chi, orbit))
+					r.list[rep] += chi * it->second / (Tfloat)orbit;
+			}
+			r.Simplify();
+			return r;
+		}
+
+		// true if p is invariant under the group
+		bool isInvariant(const CPolynom<N,Tfloat>& p) const
+		{
+			if(isTrivial())
+				return true;
+
+			CPolynom<N,Tfloat> d = expand(project(p));
+			d -= p;
+			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = d.list.begin(); it != d.list.end(); ++it)
+				if(!isZero(it->second))
+					return false;
+			return true;
+		}
+
+		// action of element g on polynom
+		CPolynom<N,Tfloat> apply(const Element& g, const CPolynom<N,Tfloat>& p) const
+		{
+			CPolynom<N,Tfloat> r;
+			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+			{
+				complex<Tfloat> chi;
+				CMonom<N> m = g.apply(it->first, chi);
+				r.list[m] += chi * it->second;
+			}
+			return r;
+		}
+
+		// Poisson bracket of reduced F with full G, result is reduced.
+		// Uses {F,G} = R(sum_r |orbit(r)|*{F_r,G}), where R is the group average,
+		// so only representatives of F are paired with G. The full bracket W^G is formed
+		// before the projection, terms outside the representatives are dropped only then.
+		CPolynom<N,Tfloat> bracket(const CPolynom<N,Tfloat>& F, const CPolynom<N,Tfloat>& G) const
+		{
+			if(isTrivial())
+				return F ^ G;
+
+			CPolynom<N,Tfloat> W;
+			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = F.list.begin(); it != F.list.end(); ++it)
+			{
+				CMonom<N> rep;
+				complex<Tfloat> chi;
+				size_t orbit;
+				if(canonical(it->first, rep, chi, orbit))
+					W.list[it->first] = it->second * (Tfloat)orbit;
+			}
+			return project(W ^ G);
+		}
+
+		// Element mapping variable j to variable i with minimal j.
+		// Transform of x[i] is phase[j]^-1 * g(transform of x[j]).
+		const Element& variableSource(const size_t i, size_t& j) const
+		{
+			size_t g = 0;
+			j = i;
+			for(size_t k = 0; k < group.size(); k++)
+				for(size_t l = 0; l < j; l++)
+					if(group[k].perm[l] == i)
+					{
+						j = l;
+						g = k;
+						break;
+					}
+			return group[g];
+		}
+	};
+
+} // namespace normalform
\ No newline at end of file
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <istream>
+#include <stdexcept>
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+#include "normalform/monom.h"
+#include "normalform/polynom.h"
+
+// size of output buffer flushed to the stream
+#ifndef NF_WRITE_BUFFER
+#define NF_WRITE_BUFFER (1 << 20)
+#endif
+
+namespace normalform {
+
+	// Locale-free float formatting, format is 'g', 'f' or 'e', precision < 0 gives
+	// round-trip representation in general format. Returns end of written chars.
+	template<class Tfloat>
+	inline char* formatFloat(char* buf, char* end, const Tfloat x, const char format, const int precision)
+	{
+#if __cplusplus >= 201703L
+		std::chars_format fmt = (format == 'f') ? std::chars_format::fixed : (format == 'e') ? std::chars_format::scientific : std::chars_format::general;
+		std::to_chars_result r = (precision < 0) ? std::to_chars(buf, end, x) : std::to_chars(buf, end, x, fmt, precision);
+		return r.ptr;
+#else
+		char spec[] = "%.*Lg";
+		spec[4] = (precision < 0) ? 'g' : format;
+		int p = (precision < 0) ? std::numeric_limits<Tfloat>::digits10 + 3 : precision;
+		int n = snprintf(buf, end - buf, spec, p, (long double)x);
+		return buf + std::min(n, (int)(end - buf - 1));
+#endif
+	}
+
+	inline const char* parseFloat(const char* begin, const char* end, double& x)
+	{
+#if __cplusplus >= 201703L
+		return std::from_chars(begin, end, x).ptr;
+#else
+		char* stop;
+		(void)end;
+		x = strtod(begin, &stop);
+		return stop;
+#endif
+	}
+
+	inline const char* parseFloat(const char* begin, const char* end, long double& x)
+	{
+#if __cplusplus >= 201703L
+		return std::from_chars(begin, end, x).ptr;
+#else
+		char* stop;
+		(void)end;
+		x = strtold(begin, &stop);
+		return stop;
+#endif
+	}
+
+	inline const char* parseFloat(const char* begin, const char* end, float& x)
+	{
+#if __cplusplus >= 201703L
+		return std::from_chars(begin, end, x).ptr;
+#else
+		char* stop;
+		(void)end;
+		x = strtof(begin, &stop);
+		return stop;
+#endif
+	}
+
+	// Buffered text output of polynoms and series.
+	// Pretty format is the one of operator<< in prettyprint.h, data format is
+	// "NF <N> <order>" header followed by "<n> <powers> <re> <im>" lines, see readSerie().
+	class CTextWriter
+	{
+	public:
+		CTextWriter(std::ostream& s)
+			: stream(s), precision((int)s.precision()), format('g')
+		{
+			std::ios::fmtflags floatfield = s.flags() & std::ios::floatfield;
+			if(floatfield == std::ios::fixed)
+				format = 'f';
+			else if(floatfield == std::ios::scientific)
+				format = 'e';
+		}
+
+		~CTextWriter()
+		{
+			flush();
+		}
+
+		void flush()
+		{
+			if(!buffer.empty())
+				stream.write(&buffer[0], buffer.size());
+			buffer.clear();
+		}
+
+		CTextWriter& put(const char* s)
+		{
+			buffer.append(s);
+			return *this;
+		}
+
+		CTextWriter& put(const size_t n)
+		{
+			char buf[32];
+			char* end = buf + sizeof(buf);
+			char* p = end;
+			size_t m = n;
+			do
+			{
+				*--p = (char)('0' + m % 10);
+				m /= 10;
+			} while(m);
+			buffer.append(p, end);
+			return *this;
+		}
+
+		template<class Tfloat>
+		CTextWriter& put(const Tfloat x, const bool showpos, const int prec)
+		{
+			char buf[128];
+			char* p = buf;
+			if(showpos && !(x < (Tfloat)0) && !(x == (Tfloat)0 && (Tfloat)1 / x < (Tfloat)0))
+				*p++ = '+';
+			p = formatFloat(p, buf + sizeof(buf), x, format, prec);
+			buffer.append(buf, p);
+			return *this;
+		}
+
+		template<size_t N>
+		CTextWriter& put(const CMonom<N>& m)
+		{
+			for(size_t i = 0; i < 2*N; i++)
+			{
+				if(m[i])
+				{
+					if(i < N)
+						put("q").put(i+1);
+					else
+						put("p").put(i+1-N);
+
+					if(m[i] > 1)
+						put("^").put((size_t)m[i]);
+
+					put(" ");
+				}
+			}
+			return *this;
+		}
+
+		template<class Tfloat>
+		CTextWriter& put(const complex<Tfloat>& c)
+		{
+			if(c.imag() == 0)
+				put(c.real(), true, precision);
+			else if(c.real() == 0)
+				put(c.imag(), true, precision).put("*I");
+			else
+				put("+(").put(c.real(), false, precision).put(c.imag(), true, precision).put("*I");
+			return *this;
+		}
+
+		// terms in canonical order, only pointers to terms are sorted
+		template<size_t N,class Tfloat>
+		CTextWriter& put(const CPolynom<N,Tfloat>& p)
+		{
+			typedef typename CPolynom<N,Tfloat>::CMonomMap::value_type term;
+			std::vector<const term*> terms;
+			sorted(p, terms);
+			for(size_t k = 0; k < terms.size(); k++)
+			{
+				put(terms[k]->second).put(" ").put(terms[k]->first);
+				check();
+			}
+			return *this;
+		}
+
+		template<class Serie>
+		CTextWriter& putSerie(const Serie& H)
+		{
+			typedef typename Serie::value_type::float_type Tfloat;
+
+			Tfloat factorial = (Tfloat)1;
+			for(size_t i = 0; i < H.size(); i++)
+			{
+				if(i > 0)
+					factorial *= i;
+
+				if(H[i].list.empty())
+					continue;
+
+				if(i)
+				{
+					put(" + eps");
+					if(i > 1)
+						put("^").put(i);
+
+					if(factorial > (Tfloat)1.5)
+						put("/").put(factorial, false, precision);
+
+					put(" ");
+				}
+
+				put("(").put(H[i]).put(")");
+			}
+			return *this;
+		}
+
+		// machine-parseable format with round-trip precision
+		template<class Serie>
+		CTextWriter& putData(const Serie& H)
+		{
+			typedef typename Serie::value_type polynom_type;
+			typedef typename polynom_type::CMonomMap::value_type term;
+			const size_t N = polynom_type::dimension;
+
+			put("NF ").put(N).put(" ").put(H.size()).put("\n");
+			for(size_t n = 0; n < H.size(); n++)
+			{
+				std::vector<const term*> terms;
+				sorted(H[n], terms);
+				for(size_t k = 0; k < terms.size(); k++)
+				{
+					put(n);
+					for(size_t i = 0; i < 2*N; i++)
+						put(" ").put((size_t)terms[k]->first[i]);
+					put(" ").put(terms[k]->second.real(), false, -1);
+					put(" ").put(terms[k]->second.imag(), false, -1);
+					put("\n");
+					check();
+				}
+			}
+			return *this;
+		}
+
+	private:
+		std::ostream& stream;
+		std::string buffer;
+		int precision;
+		char format;
+
+		void check()
+		{
+			if(buffer.size() >= NF_WRITE_BUFFER)
+				flush();
+		}
+
+		template<class T>
+		static bool less(const T* t1, const T* t2)
+		{
+			return t1->first < t2->first;
+		}
+
+		template<size_t N,class Tfloat>
+		static void sorted(const CPolynom<N,Tfloat>& p, std::vector<const typename CPolynom<N,Tfloat>::CMonomMap::value_type*>& terms)
+		{
+			typedef typename CPolynom<N,Tfloat>::CMonomMap::value_type term;
+			terms.reserve(p.list.size());
+			for(typename CPolynom<N,Tfloat>::CMonomMap::const_iterator it = p.list.begin(); it != p.list.end(); ++it)
+				terms.push_back(&*it);
+			std::sort(terms.begin(), terms.end(), less<term>);
+		}
+	};
+
+	// write serie in data format
+	template<class Serie>
+	inline void writeSerie(std::ostream& stream, const Serie& H)
+	{
+		CTextWriter writer(stream);
+		writer.putData(H);
+	}
+
+	template<class T,size_t order>
+	inline void resizeSerie(boost::array<T,order>&, const size_t n)
+	{
+		if(n > order)
+			throw std::runtime_error("normalform: serie order mismatch");
+	}
+
+	template<class T>
+	inline void resizeSerie(std::vector<T>& H, const size_t n)
+	{
+		H.resize(n);
+	}
+
+	// unsigned number after blanks on the same line, throws if there is none
+	inline const char* parseSize(const char* p, const char* end, size_t& n)
+	{
+		while(p < end && (*p == ' ' || *p == '\t'))
+			p++;
+		if(p == end || *p < '0' || *p > '9')
+			throw std::runtime_error("normalform: bad serie format");
+		char* stop;
+		n = strtoul(p, &stop, 10);
+		return stop;
+	}
+
+	// coefficient after blanks on the same line, throws if there is none
+	template<class Tfloat>
+	inline const char* parseCoeff(const char* p, const char* end, Tfloat& x)
+	{
+		while(p < end && (*p == ' ' || *p == '\t'))
+			p++;
+		const char* stop = parseFloat(p, end, x);
+		if(stop == p)
+			throw std::runtime_error("normalform: bad serie format");
+		return stop;
+	}
+
+	// end of line, throws on anything but blanks before it
+	inline const char* parseLineEnd(const char* p, const char* end)
+	{
+		while(p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+			p++;
+		if(p < end && *p != '\n')
+			throw std::runtime_error("normalform: bad serie format");
+		return (p < end) ? p + 1 : p;
+	}
+
+	// read serie written by writeSerie(), series with runtime order are resized
+	template<class Serie>
+	inline void readSerie(std::istream& stream, Serie& H)
+	{
+		typedef typename Serie::value_type polynom_type;
+		typedef typename polynom_type::float_type Tfloat;
+		const size_t N = polynom_type::dimension;
+
+		std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+		const char* p = text.c_str();
+		const char* end = p + text.size();
+
+		if(strncmp(p, "NF ", 3))
+			throw std::runtime_error("normalform: bad serie format");
+		size_t n, order;
+		p = parseSize(p + 3, end, n);
+		p = parseSize(p, end, order);
+		p = parseLineEnd(p, end);
+		if(n != N)
+			throw std::runtime_error("normalform: dimension mismatch");
+		resizeSerie(H, order);
+
+		for(size_t i = 0; i < H.size(); i++)
+			H[i].Clear();
+
+		for(;;)
+		{
+			// blank lines
+			while(p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+				p++;
+			if(p == end)
+				break;
+
+			size_t k;
+			p = parseSize(p, end, k);
+			if(k >= H.size())
+				throw std::runtime_error("normalform: bad serie format");
+
+			CMonom<N> m;
+			for(size_t i = 0; i < 2*N; i++)
+			{
+				size_t power;
+				p = parseSize(p, end, power);
+				if(power > (size_t)std::numeric_limits<IntPower>::max())
+					throw std::runtime_error("normalform: bad serie format");
+				m[i] = (IntPower)power;
+			}
+
+			Tfloat re, im;
+			p = parseCoeff(p, end, re);
+			p = parseCoeff(p, end, im);
+			p = parseLineEnd(p, end);
+
+			H[k].list[m] = complex<Tfloat>(re, im);
+		}
+	}
+
+} // namespace normalform
\ No newline at end of file